@@ -0,0 +1,82 @@
+#include <chrono>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../include/zlib/zlib.h"
+#include "../include/PNG/CRC32.h"
+
+/**
+ * @brief crc32 micro-benchmark : each CRC32 engine is checked against zlib crc32() then timed on several buffer sizes.
+ * @details usage : crc32_bench [total MiB per measure, default 256]
+ *
+ */
+int main(int argc, char **argv)
+{
+    const std::size_t total = static_cast<std::size_t>(argc > 1 ? std::atoi(argv[1]) : 256) << 20;
+    const std::size_t sizes[] = {13, 64, 1000, 64 * 1024, 16 << 20};
+    const char *names[] = {"bytewise", "slice-by-8", "pclmul"};
+
+    std::vector<uint8_t> datas((16 << 20) + 8); // the measures read from offsets 0 to 7
+    std::mt19937 random(42);
+    for (auto &byte : datas)
+        byte = static_cast<uint8_t>(random());
+
+    // correctness : all the lengths and alignments of a small buffer, incremental updates and combination
+    int errors = 0;
+    for (int engine = 0; engine < 3; ++engine)
+    {
+        CRC32::set_engine(static_cast<CRC32::Engine>(engine));
+        for (std::size_t offset = 0; offset < 16; ++offset)
+            for (std::size_t len = 0; len < 600; ++len)
+            {
+                uint32_t expected = crc32(0L, datas.data() + offset, len);
+                std::size_t half = len / 3;
+                errors += CRC32::update(0, datas.data() + offset, len) != expected;
+                errors += CRC32::update(CRC32::update(0, datas.data() + offset, half), datas.data() + offset + half, len - half) != expected;
+                errors += CRC32::combine(CRC32::update(0, datas.data() + offset, half), CRC32::update(0, datas.data() + offset + half, len - half), len - half) != expected;
+            }
+        errors += CRC32::update(0, datas.data(), 16 << 20) != crc32(0L, datas.data(), 16 << 20);
+    }
+    std::printf("correctness against zlib : %s\n\n", errors ? "FAILED" : "ok");
+
+    std::printf("%-12s", "size");
+    std::printf("%14s", "zlib");
+    for (auto name : names)
+        std::printf("%14s", name);
+    std::printf("   (GiB/s)\n");
+
+    for (std::size_t size : sizes)
+    {
+        std::size_t rounds = std::max<std::size_t>(1, total / size);
+        auto measure = [&](auto &&checksum)
+        {
+            uint32_t crc = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < rounds; ++i)
+                crc ^= checksum(datas.data() + (i & 7), size);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            volatile uint32_t sink = crc; // keeps the loop alive
+            (void)sink;
+            return static_cast<double>(rounds) * size / seconds / (1 << 30);
+        };
+
+        std::printf("%-12zu", size);
+        std::printf("%14.2f", measure([](const uint8_t *buffer, std::size_t len) { return static_cast<uint32_t>(crc32(0L, buffer, len)); }));
+        for (int engine = 0; engine < 3; ++engine)
+        {
+            CRC32::set_engine(static_cast<CRC32::Engine>(engine));
+            if (CRC32::get_engine() != static_cast<CRC32::Engine>(engine))
+            {
+                std::printf("%14s", "unsupported");
+                continue;
+            }
+            std::printf("%14.2f", measure([](const uint8_t *buffer, std::size_t len) { return CRC32::update(0, buffer, len); }));
+        }
+        std::printf("\n");
+    }
+
+    return errors ? 1 : 0;
+}
@@ -11,6 +11,20 @@ g++^
  "src/PNG/Chunks/IEND_CHUNK.cpp"^
  "src/PNG/PNG.cpp"^
  "src/PNG/Utilities.cpp"^
+ "src/PNG/ChunkWalker.cpp"^
+ "src/PNG/ScanlineDecoder.cpp"^
+ "src/PNG/Filters.cpp"^
+ "src/PNG/PNGWriter.cpp"^
+ "src/PNG/OutputSink.cpp"^
+ "src/PNG/PixelExpander.cpp"^
+ "src/PNG/Chunks/PLTE_CHUNK.cpp"^
+ "src/PNG/Chunks/TRNS_CHUNK.cpp"^
+ "src/PNG/Palette.cpp"^
+ "src/PNG/Adam7.cpp"^
+ "src/PixelsManager/Blur.cpp"^
+ "src/PixelsManager/Histogram.cpp"^
+ "src/PixelsManager/ColorStats.cpp"^
+ "src/PixelsManager/KMeans.cpp"^
  -c -L"./lib" -m32 -lopengl32 -lglut32 -lz
 
 @echo off
@@ -0,0 +1,26 @@
+#ifndef _ADAM7_H_INCLUDED_
+#define _ADAM7_H_INCLUDED_
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @namespace Adam7
+ * @brief Adam7 interlacing : the image is sent in 7 passes, each one being a sub-image of the pixels on a regular grid.
+ * @details the pass lines are filtered independently (each pass restarts with a line of 0), then their pixels are
+ * scattered in the final image, with copies specialized for each pixel size.
+ */
+namespace Adam7
+{
+    constexpr int passNumber = 7; /**< the number of Adam7 passes */
+
+    int get_passWidth(int pass, int width) noexcept;
+    int get_passHeight(int pass, int height) noexcept;
+    int get_passRow(int pass, int line) noexcept;
+    int get_gridPass(int scale) noexcept;
+
+    void scatter_line(uint8_t *row, const uint8_t *line, int pass, int width, int bytesPerPixel, int scale = 1) noexcept;
+    void fill_missing(uint8_t *image, std::size_t stride, int width, int height, int bytesPerPixel, int lastPass, int scale = 1) noexcept;
+}
+
+#endif //_ADAM7_H_INCLUDED_
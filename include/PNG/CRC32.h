@@ -1,16 +1,24 @@
 #ifndef _CRC_32_H_INCLUDED_
 #define _CRC_32_H_INCLUDED_
 
+#include <cstddef>
 #include <iostream>
 #include <cstdint>
 
 /**
- * @brief CRC32 class, for CRC32 algorithm. 
- * 
+ * @brief CRC32 class, for CRC32 algorithm.
+ * @details checksums are computed with slice-by-8 tables, or with carry-less multiplications (PCLMULQDQ)
+ * when the running cpu supports it, the implementation is selected at runtime.
+ *
  */
 class CRC32
 {
     public :
+        /**
+         * @enum set of crc32 implementations, from the slowest to the fastest
+         */
+        enum class Engine { BYTEWISE = 0x0, SLICE_BY_8 = 0x1, PCLMUL = 0x2 };
+
         CRC32();
         ~CRC32();
         void crc_table_compute();
@@ -18,8 +26,14 @@ class CRC32
         static uint32_t CRC32_update(uint32_t crc, uint8_t *dataCHUNK, int len);
         static void CRC32_table_compute(void);
 
+        static uint32_t update(uint32_t crc, const uint8_t *datas, std::size_t len) noexcept;
+        static uint32_t combine(uint32_t crc1, uint32_t crc2, std::size_t len2) noexcept;
+
+        static Engine get_engine() noexcept;
+        static void set_engine(Engine engine) noexcept;
+
         static uint32_t crc_table[256];
         static bool crc_table_computed;
 };
 
-#endif //_CRC_32_H_INCLUDED_
\ No newline at end of file
+#endif //_CRC_32_H_INCLUDED_
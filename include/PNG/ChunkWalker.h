@@ -0,0 +1,53 @@
+#ifndef _CHUNK_WALKER_H_INCLUDED_
+#define _CHUNK_WALKER_H_INCLUDED_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+/**
+ * @brief ChunkWalker class, single pass PNG chunks parser.
+ * @details the png file is memory mapped (or an in memory png is used as is), then the chunks list is walked once using the length field of each chunk.
+ * Each chunk is recorded as (type, data, crc32) where data points directly inside the mapped file (no copy).
+ *
+ */
+class ChunkWalker
+{
+    public :
+        /**
+         * @brief a chunk record, the data pointer is only valid while the walker is alive
+         */
+        struct Chunk
+        {
+            uint32_t length; /**< the length of the chunk datas */
+            uint8_t type[4]; /**< the type of the chunk (4 ASCII letters) */
+            const uint8_t *data; /**< pointer to the chunk datas, inside the mapped file */
+            uint32_t crc32; /**< the crc32 stored in the file for this chunk */
+
+            bool is(const char *chunkType) const noexcept;
+        };
+
+        ChunkWalker(const std::string &path);
+        ChunkWalker(const uint8_t *datas, std::size_t len);
+        ~ChunkWalker();
+
+        ChunkWalker(const ChunkWalker &) = delete;
+        ChunkWalker &operator=(const ChunkWalker &) = delete;
+
+        const std::vector<Chunk> &get_chunks() const noexcept;
+        const Chunk *find(const char *chunkType) const noexcept;
+        std::vector<const Chunk *> find_all(const char *chunkType) const;
+
+    private :
+        const uint8_t *m_mapped = nullptr; /**< the mapped file content, or the caller's png datas */
+        std::size_t m_mappedLen = 0; /**< the mapped file length */
+        bool m_owned = false; /**< if the datas are a mapping owned by the walker */
+        std::vector<Chunk> m_chunks; /**< chunks records, in file order */
+
+        void walk();
+        void unmap() noexcept;
+};
+
+#endif //_CHUNK_WALKER_H_INCLUDED_
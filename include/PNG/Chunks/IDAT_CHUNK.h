@@ -4,11 +4,16 @@
 #include <cstdio>
 #include <thread>
 #include <future>
+#include <vector>
 #include <cstring>
 #include <fstream>
 #include <iostream>
 #include <algorithm>
 
+#include "../../zlib/zlib.h"
+#include "../EncodeOptions.h"
+#include "../OutputSink.h"
+
 
 /**
  * @brief IDAT CHUNK class, CRITICAL.
@@ -17,10 +22,10 @@
 class IDAT_CHUNK
 {   
     public :
-        IDAT_CHUNK(const uint8_t *pixelsBuffer, int s_width, int s_height, int colorChannel);
+        IDAT_CHUNK(const uint8_t *pixelsBuffer, int s_width, int s_height, int colorChannel, const EncodeOptions &options = EncodeOptions());
         ~IDAT_CHUNK();
         
-        void save(std::ofstream &outputStream);
+        void save(OutputSink &sink);
 
     private : 
         int m_length; /**< the length of the CHUNK */
@@ -29,11 +34,16 @@ class IDAT_CHUNK
         uint8_t *pixelsBuffer = nullptr; /**< the input pixels buffer*/
         unsigned long m_crc32; /**< the crc32 value computed from the concatened buffers of type and datas*/
 
-        uint8_t *generate_scanlines(const uint8_t *pixelBuffer, int s_width, int s_height, int colorChannel);
-        uint8_t *deflate_datas(const uint8_t *pixelBuffer, int s_width, int s_height, int colorChannel, int &deflatedLen);
-        uint8_t *filter_line(const uint8_t *line_in, int lineLength, uint8_t filterMode, bool is_prev_line, const uint8_t *unfiltered_prev_line, uint8_t colorChannel);
+        static constexpr unsigned long minBandLength = 256 * 1024; /**< the minimum scanlines length deflated by each thread */
+
+        uint8_t *generate_scanlines(const uint8_t *pixelBuffer, int s_width, int s_height, int colorChannel, const Filters::Strategy &filtering, const EncodeOptions &options);
+        uint8_t *deflate_datas(const uint8_t *pixelBuffer, int s_width, int s_height, int colorChannel, const EncodeOptions &options, int &deflatedLen);
+        uint8_t *deflate_bands(const uint8_t *scanlines, int s_height, int scanlineLength, int level, const EncodeOptions &options, int bandNumber, int &deflatedLen);
+        static int get_thread_number(const EncodeOptions &options) noexcept;
+        static uint8_t trial_filter(z_stream &trialStream, std::vector<uint8_t> &trialDatas, uint8_t *line_out, const uint8_t *line, const uint8_t *prev_line, int lineLength, int colorChannel);
 
     friend class PNG;
+    friend class PNGWriter;
 };
 
 #endif // _IDAT_CHUNK_H_INCLUDED_
\ No newline at end of file
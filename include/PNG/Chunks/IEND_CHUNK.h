@@ -4,6 +4,8 @@
 #include <cstdio>
 #include <fstream>
 
+#include "../OutputSink.h"
+
 /**
  * @brief IEND CHUNK class, CRITICAL.
  * 
@@ -14,7 +16,7 @@ class IEND_CHUNK
         IEND_CHUNK();
         ~IEND_CHUNK();
         
-        void save(std::ofstream &outputStream);
+        void save(OutputSink &sink);
 
     private : 
         int m_length; /**< the length of the CHUNK */
@@ -4,6 +4,8 @@
 #include <cstdio>
 #include <fstream>
 
+#include "../OutputSink.h"
+
 
 /**
  * @brief IHDR CHUNK class, CRITICAL.
@@ -21,7 +23,8 @@ class IHDR_CHUNK
         uint8_t get_colorMode();
         uint8_t get_interlacing();
 
-        void save(std::ofstream &outputStream);
+        void save(OutputSink &sink);
+        static void read_datas(const uint8_t *datas, int &width, int &height, uint8_t &bitDepth, uint8_t &colorMode, uint8_t &interlacing) noexcept;
 
     private : 
         int m_length; /**< the length of the CHUNK */
@@ -32,6 +35,8 @@ class IHDR_CHUNK
         uint8_t *m_data = nullptr; /**< the datas inside the CHUNK*/
         uint8_t *pixelsBuffer = nullptr; /**< the input pixels buffer*/
     
+        void get_datas(uint8_t *datas) const noexcept;
+    
     friend class PNG;
 };
 
@@ -4,6 +4,8 @@
 #include <cstdio>
 #include <fstream>
 
+#include "../OutputSink.h"
+
 /**
  * @brief pHYs CHUNK class, AUXILIARY.
  * 
@@ -14,7 +16,7 @@ class PHYS_CHUNK
         PHYS_CHUNK(unsigned int ppuX, unsigned int ppuY, uint8_t unitSpecifier);
         ~PHYS_CHUNK();
         
-        void save(std::ofstream &outputStream);
+        void save(OutputSink &sink);
         bool get_state();
 
     private :
@@ -25,6 +27,8 @@ class PHYS_CHUNK
         unsigned int m_ppuX; /**< the physical pixel dimension (on x axis)*/
         unsigned int m_ppuY; /**< the physical pixel dimension (on y axis)*/
         uint8_t m_unitSpecifier; /**< the unit specifier of the phisical pixel dimension on x and y axis*/
+
+        void get_datas(uint8_t *datas) const noexcept;
     
     friend class PNG;
 };  
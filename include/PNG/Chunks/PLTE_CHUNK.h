@@ -0,0 +1,35 @@
+#ifndef _PLTE_CHUNK_H_INCLUDED_
+#define _PLTE_CHUNK_H_INCLUDED_
+
+#include <cstdio>
+#include <fstream>
+
+#include "../OutputSink.h"
+
+/**
+ * @brief PLTE CHUNK class, CRITICAL for palette pngs.
+ * 
+ */
+class PLTE_CHUNK
+{
+    public :
+        PLTE_CHUNK(const uint8_t *colors, int entries);
+        ~PLTE_CHUNK();
+
+        PLTE_CHUNK(const PLTE_CHUNK &) = delete;
+        PLTE_CHUNK &operator=(const PLTE_CHUNK &) = delete;
+
+        void save(OutputSink &sink);
+        int get_entries() const noexcept;
+        uint8_t get_bitDepth() const noexcept;
+
+    private :
+        int m_length; /**< the length of the CHUNK, 3 bytes per palette entry */
+        uint32_t m_crc32; /**< the crc32 value computed from the concatened buffers of type and datas*/
+        uint8_t *m_type = nullptr; /**< the type of the CHUNK corresponding to the name of the chunk in hexadecimal*/
+        uint8_t *m_data = nullptr; /**< the RGB colors of the palette entries*/
+
+    friend class PNG;
+};
+
+#endif // _PLTE_CHUNK_H_INCLUDED_
@@ -0,0 +1,33 @@
+#ifndef _TRNS_CHUNK_H_INCLUDED_
+#define _TRNS_CHUNK_H_INCLUDED_
+
+#include <cstdio>
+#include <fstream>
+
+#include "../OutputSink.h"
+
+/**
+ * @brief tRNS CHUNK class, AUXILIARY. Only the palette form (alpha of the first palette entries) is written.
+ * 
+ */
+class TRNS_CHUNK
+{
+    public :
+        TRNS_CHUNK(const uint8_t *alphas, int entries);
+        ~TRNS_CHUNK();
+
+        TRNS_CHUNK(const TRNS_CHUNK &) = delete;
+        TRNS_CHUNK &operator=(const TRNS_CHUNK &) = delete;
+
+        void save(OutputSink &sink);
+
+    private :
+        int m_length; /**< the length of the CHUNK, 1 byte per palette entry */
+        uint32_t m_crc32; /**< the crc32 value computed from the concatened buffers of type and datas*/
+        uint8_t *m_type = nullptr; /**< the type of the CHUNK corresponding to the name of the chunk in hexadecimal*/
+        uint8_t *m_data = nullptr; /**< the alpha values of the first palette entries*/
+
+    friend class PNG;
+};
+
+#endif // _TRNS_CHUNK_H_INCLUDED_
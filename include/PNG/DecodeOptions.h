@@ -0,0 +1,44 @@
+#ifndef _DECODE_OPTIONS_H_INCLUDED_
+#define _DECODE_OPTIONS_H_INCLUDED_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/**
+ * @brief png decoding options, for decoding only a part of the image, or a reduced image.
+ * @details the scanlines are inflated sequentially : rows above the region are unfiltered in a scratch line without being stored,
+ * only the region columns are copied, and the decompression stops after the last row of the region.
+ * With a scale, blocks of scale x scale pixels are averaged while the rows are unfiltered, only one row of sums is kept.
+ * @see PNG::read_pixels
+ */
+struct DecodeOptions
+{
+    /**
+     * @brief a rectangle of the image, in pixels
+     */
+    struct Region
+    {
+        int x = 0; /**< the first column of the region */
+        int y = 0; /**< the first row of the region */
+        int width = 0; /**< the region width, 0 for all the columns from x to the right edge */
+        int height = 0; /**< the region height, 0 for all the rows from y to the bottom edge */
+    };
+
+    /**
+     * @brief function called after each Adam7 pass of an interlaced png (pass from 1 to 7), with the full resolution image
+     * being decoded (before region and scale). Returning false stops the decoding : the pixels of the next passes are
+     * filled with the decoded ones, giving a coarse image.
+     * With a scale, only the passes up to the one filling the scale grid are decoded, and the image is the grid image :
+     * the pixels (x, y) with x % scale == 0 and y % scale == 0 of the whole png, stored at (x / scale, y / scale).
+     */
+    using PassCallback = std::function<bool(int pass, const uint8_t *pixels, std::size_t stride)>;
+
+    Region region; /**< the decoded region, the whole image by default */
+    int scale = 1; /**< the reduction factor of the decoded region : 1, 2, 4 or 8. Partial blocks on the right and bottom edges are averaged too,
+                        interlaced pngs are sampled instead : each block takes its pixel of the first Adam7 passes */
+    PassCallback onPass; /**< the progressive rendering function of interlaced pngs, none by default */
+    bool nativeOrder = false; /**< 16 bits samples in the cpu byte order instead of the png big endian order, only for PNG::decode_into */
+};
+
+#endif //_DECODE_OPTIONS_H_INCLUDED_
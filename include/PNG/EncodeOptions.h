@@ -0,0 +1,28 @@
+#ifndef _ENCODE_OPTIONS_H_INCLUDED_
+#define _ENCODE_OPTIONS_H_INCLUDED_
+
+#include "../zlib/zlib.h"
+#include "Filters.h"
+
+/**
+ * @brief png encoding options, trading the encoding cpu time against the file size.
+ * @details the zlib fields are directly given to deflateInit2(), see the zlib manual for their exact meaning.
+ * The defaults give the smallest files (zlib level 9), faster levels are usually a better choice for short lived images.
+ * @see IDAT_CHUNK::deflate_datas
+ */
+struct EncodeOptions
+{
+    int level = Z_BEST_COMPRESSION; /**< the zlib compression level, from 0 (no compression) to 9 (best compression) */
+    int strategy = Z_DEFAULT_STRATEGY; /**< the zlib strategy : Z_DEFAULT_STRATEGY, Z_FILTERED, Z_HUFFMAN_ONLY, Z_RLE or Z_FIXED */
+    int windowBits = 15; /**< the base two logarithm of the deflate window size, from 9 to 15 (png requires a window of at most 32K) */
+    int memLevel = 8; /**< the zlib memory level, from 1 (less memory, slower) to 9 (more memory, faster) */
+    int threads = 0; /**< the number of encoding threads, 0 for all the hardware threads. With 1 thread, scanlines are deflated in a single zlib stream */
+    bool store = false; /**< store mode : the scanlines are neither filtered nor compressed, for scratch images. Overrides level and filtering */
+    bool palette = false; /**< palette encoding (color mode 3, 1 to 8 bits indices) of 8 bits RGB and RGBA images of at most 256 colors */
+    bool quantize = false; /**< with palette encoding, RGB images of more than 256 colors are quantized to 256 colors */
+    int quantizeIterations = 10; /**< the number of k-means iterations of the quantization */
+
+    Filters::Strategy filtering; /**< the filter selection strategy of each scanline */
+};
+
+#endif //_ENCODE_OPTIONS_H_INCLUDED_
@@ -0,0 +1,51 @@
+#ifndef _FILTERS_H_INCLUDED_
+#define _FILTERS_H_INCLUDED_
+
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * @namespace Filters
+ * @brief png scanlines filtering kernels (None, Sub, Up, Average, Paeth).
+ * @details kernels are vectorized (SSE2, AVX2) when the running cpu supports it, the best set of kernels is selected at runtime.
+ * They work on caller supplied lines and never allocate.
+ */
+namespace Filters
+{
+    /**
+     * @enum set of kernels implementations, from the slowest to the fastest
+     */
+    enum class SimdLevel { SCALAR = 0x0, SSE2 = 0x1, AVX2 = 0x2 };
+
+    /**
+     * @enum set of strategies for choosing the filter mode of each line when encoding
+     */
+    enum class Selection
+    {
+        FIXED = 0x0,         /**< the same filter mode for all lines */
+        MIN_SUM_ABS = 0x1,   /**< the filter mode with the minimum sum of absolute differences, for each line */
+        ADAPTIVE_FAST = 0x2, /**< same as MIN_SUM_ABS, but lines are only scored periodically, the others reuse the last choice */
+        BRUTE_FORCE = 0x3    /**< each filter mode is trial deflated, the smallest output is kept. Very slow */
+    };
+
+    /**
+     * @brief filter selection strategy used when encoding
+     */
+    struct Strategy
+    {
+        Selection selection = Selection::MIN_SUM_ABS; /**< how the filter mode of each line is chosen */
+        uint8_t fixedFilter = 0x4; /**< the filter mode used by Selection::FIXED ( 0 = none, 1 = Sub, 2 = Up, 3 = Average, 4 = Paeth) */
+        int rescoreInterval = 8; /**< the number of lines sharing the same filter mode, for Selection::ADAPTIVE_FAST */
+    };
+
+    void unfilter_line(uint8_t *line, const uint8_t *prev_line, int lineLength, uint8_t filterMode, int bpp);
+    void filter_line(uint8_t *line_out, const uint8_t *line, const uint8_t *prev_line, int lineLength, uint8_t filterMode, int bpp);
+    void score_filters(const uint8_t *line, const uint8_t *prev_line, int lineLength, int bpp, uint64_t scores[5]);
+    uint8_t select_filter(const uint8_t *line, const uint8_t *prev_line, int lineLength, int bpp);
+    void swap_samples16(uint8_t *line_out, const uint8_t *line, int lineLength) noexcept;
+
+    SimdLevel get_simd_level() noexcept;
+    void set_simd_level(SimdLevel level) noexcept;
+};
+
+#endif //_FILTERS_H_INCLUDED_
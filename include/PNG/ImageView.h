@@ -0,0 +1,77 @@
+#ifndef _IMAGE_VIEW_H_INCLUDED_
+#define _IMAGE_VIEW_H_INCLUDED_
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * @brief ImageView struct, a typed and non-owning view of interleaved pixels (uint8_t, uint16_t or float samples).
+ * @details the rows can be padded : two rows are separated by stride samples. 16 bits samples are in the cpu byte order,
+ * they can be decoded this way by PNG::decode_into.
+ * @see PNG::decode_into
+ *
+ * @tparam T the sample type, const for a read-only view
+ */
+template <typename T>
+struct ImageView
+{
+    using sample_type = std::remove_const_t<T>; /**< the sample type, without const */
+
+    T *data = nullptr; /**< the first sample of the first row */
+    int width = 0; /**< the image width, in pixels */
+    int height = 0; /**< the image height, in pixels */
+    int channels = 0; /**< the number of samples per pixel */
+    std::size_t stride = 0; /**< the distance between two rows, in samples */
+
+    ImageView() = default;
+
+    /**
+     * @brief Construct a new ImageView object
+     *
+     * @param data the first sample of the first row
+     * @param width the image width, in pixels
+     * @param height the image height, in pixels
+     * @param channels the number of samples per pixel
+     * @param stride the distance between two rows in samples, 0 for contiguous rows
+     */
+    ImageView(T *data, int width, int height, int channels, std::size_t stride = 0) noexcept
+        : data(data), width(width), height(height), channels(channels),
+          stride((stride == 0) ? static_cast<std::size_t>(width) * channels : stride)
+    {
+    }
+
+    /**
+     * @brief Construct a read-only view of a writable view
+     *
+     * @param view the writable view
+     */
+    template <typename U, typename = std::enable_if_t<std::is_same<const U, T>::value && !std::is_same<U, T>::value>>
+    ImageView(const ImageView<U> &view) noexcept
+        : data(view.data), width(view.width), height(view.height), channels(view.channels), stride(view.stride)
+    {
+    }
+
+    T *row(int y) const noexcept { return data + y * stride; }
+    T &at(int x, int y, int channel = 0) const noexcept { return data[y * stride + static_cast<std::size_t>(x) * channels + channel]; }
+
+    /**
+     * @brief view of a region of the image, sharing its rows
+     *
+     * @param x the left column of the region
+     * @param y the top row of the region
+     * @param regionWidth the region width, in pixels
+     * @param regionHeight the region height, in pixels
+     * @return ImageView the region view, with the stride of the image
+     */
+    ImageView region(int x, int y, int regionWidth, int regionHeight) const noexcept
+    {
+        return ImageView(&at(x, y), regionWidth, regionHeight, channels, stride);
+    }
+
+    std::size_t row_samples() const noexcept { return static_cast<std::size_t>(width) * channels; }
+    std::size_t size() const noexcept { return (height > 0) ? (height - 1) * stride + row_samples() : 0; }
+    bool is_contiguous() const noexcept { return stride == row_samples(); }
+};
+
+#endif //_IMAGE_VIEW_H_INCLUDED_
@@ -0,0 +1,87 @@
+#ifndef _OUTPUT_SINK_H_INCLUDED_
+#define _OUTPUT_SINK_H_INCLUDED_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <functional>
+
+/**
+ * @brief OutputSink class, destination of the png bytes (file, memory, user callback).
+ * @details chunks are written as a header (length and type), the chunk datas and the crc32, without any intermediate copy
+ * of the datas.
+ *
+ */
+class OutputSink
+{
+    public :
+        virtual ~OutputSink() = default;
+
+        virtual void write(const uint8_t *datas, std::size_t len) = 0;
+        virtual void flush();
+
+        void write_chunk(const uint8_t *type, const uint8_t *datas, uint32_t len, uint32_t crc32);
+};
+
+/**
+ * @brief FileSink class, buffered file output.
+ * @details small writes (chunks headers, small chunks) are gathered in a buffer, large datas are written directly with a single call.
+ *
+ */
+class FileSink : public OutputSink
+{
+    public :
+        FileSink(const std::string &path);
+        ~FileSink();
+
+        FileSink(const FileSink &) = delete;
+        FileSink &operator=(const FileSink &) = delete;
+
+        void write(const uint8_t *datas, std::size_t len) override;
+        void flush() override;
+        void close();
+
+        static constexpr std::size_t bufferSize = 64 * 1024; /**< the size of the write buffer */
+
+    private :
+        std::FILE *m_file = nullptr; /**< the output file, not buffered by the C library */
+        std::vector<uint8_t> m_buffer; /**< the pending small writes */
+
+        void write_file(const uint8_t *datas, std::size_t len);
+};
+
+/**
+ * @brief MemorySink class, appends the png bytes to a caller's vector.
+ *
+ */
+class MemorySink : public OutputSink
+{
+    public :
+        MemorySink(std::vector<uint8_t> &output);
+
+        void write(const uint8_t *datas, std::size_t len) override;
+
+    private :
+        std::vector<uint8_t> &m_output; /**< the output vector */
+};
+
+/**
+ * @brief CallbackSink class, gives the png bytes to a user function, as they are produced.
+ *
+ */
+class CallbackSink : public OutputSink
+{
+    public :
+        using Callback = std::function<void(const uint8_t *datas, std::size_t len)>;
+
+        CallbackSink(Callback callback);
+
+        void write(const uint8_t *datas, std::size_t len) override;
+
+    private :
+        Callback m_callback; /**< the user function, called for each write */
+};
+
+#endif //_OUTPUT_SINK_H_INCLUDED_
@@ -2,7 +2,9 @@
 #define _PNG_H_INCLUDED_
 
 #include <cmath>
+#include <memory>
 #include <vector>
+#include <functional>
 #include <cstdio>
 #include <fstream>
 #include <GL/gl.h>
@@ -14,6 +16,13 @@
 #include "Chunks/PHYS_CHUNK.h"
 #include "Chunks/IDAT_CHUNK.h"
 #include "Chunks/IEND_CHUNK.h"
+#include "Chunks/PLTE_CHUNK.h"
+#include "Chunks/TRNS_CHUNK.h"
+#include "EncodeOptions.h"
+#include "DecodeOptions.h"
+#include "ImageView.h"
+#include "OutputSink.h"
+#include "ChunkWalker.h"
 
 /**
  * 
@@ -23,10 +32,30 @@
 class PNG
 {
     public :
+        /**
+         * @brief informations of a decoded png, read in its IHDR and pHYs chunks
+         */
+        struct Info
+        {
+            int width = 0; /**< the png width, in pixels */
+            int height = 0; /**< the png height, in pixels */
+            uint8_t bitDepth = 0; /**< the png bit depth */
+            uint8_t colorMode = 0; /**< the png color mode */
+            uint8_t colorChannel = 0; /**< the number of bytes per pixel */
+            uint8_t interlacing = 0; /**< the png interlace method */
+            int ppuX = 0; /**< the physical pixel dimension (on x axis), 0 without pHYs chunk */
+            int ppuY = 0; /**< the physical pixel dimension (on y axis), 0 without pHYs chunk */
+            uint8_t unitSpecifier = 0; /**< the physical pixel dimension unit */
+            bool physical = false; /**< true if the png has a pHYs chunk */
+
+            std::size_t row_bytes() const noexcept { return static_cast<std::size_t>(width) * colorChannel; }
+        };
+
         PNG(const PNG &png);
-        PNG(const std::string &path);
-        PNG(const uint8_t *pixelBuffer, int s_width, int s_height, int bitDepth, int colorMode);
-        PNG(const uint8_t *pixelBuffer, int s_width, int s_height, int bitDepth, int colorMode, unsigned int ppuX, unsigned int ppuY, uint8_t unitSpecifier);
+        PNG(PNG &&png) noexcept;
+        PNG(const std::string &path, const DecodeOptions &options = DecodeOptions());
+        PNG(const uint8_t *pixelBuffer, int s_width, int s_height, int bitDepth, int colorMode, const EncodeOptions &options = EncodeOptions());
+        PNG(const uint8_t *pixelBuffer, int s_width, int s_height, int bitDepth, int colorMode, unsigned int ppuX, unsigned int ppuY, uint8_t unitSpecifier, const EncodeOptions &options = EncodeOptions());
         ~PNG();
 
         // accessors
@@ -38,24 +67,53 @@ class PNG
         uint8_t get_interlacing() const noexcept;
 
         uint8_t *get_raw_pixels() const;
+        void set_raw_pixels(const uint8_t *pixelBuffer);
 
         void save(const std::string &path);
+        void save(OutputSink &sink);
+        void save(const std::string &path, const EncodeOptions &options);
+        void encode_to(std::vector<uint8_t> &output);
+        static PNG decode(const uint8_t *datas, std::size_t len, const DecodeOptions &options = DecodeOptions());
+        static PNG decode(const std::vector<uint8_t> &datas, const DecodeOptions &options = DecodeOptions());
+        static Info decode_into(const std::string &path, uint8_t *buffer, std::size_t bufferLen, std::size_t stride = 0, const DecodeOptions &options = DecodeOptions());
+        static Info decode_into(const uint8_t *datas, std::size_t len, uint8_t *buffer, std::size_t bufferLen, std::size_t stride = 0, const DecodeOptions &options = DecodeOptions());
+        static Info decode_into(const std::string &path, ImageView<uint16_t> image, const DecodeOptions &options = DecodeOptions());
+        static Info decode_into(const uint8_t *datas, std::size_t len, ImageView<uint16_t> image, const DecodeOptions &options = DecodeOptions());
+        static Info probe(const std::string &path, bool physical = false);
+        static Info probe(const uint8_t *datas, std::size_t len, bool physical = false);
+        static uint8_t get_colorChannels(int bitDepth, int colorMode) noexcept;
         static void glScreenshot(const std::string &png_dir, int x, int y, int width, int height, int bitDepth, int colorMode, int colorChannel, unsigned int ppuX, unsigned int ppuY, uint8_t unitSpecifier);
 
         PNG &operator=(const PNG &png_src);
+        PNG &operator=(PNG &&png_src) noexcept;
 
     private : 
-        uint8_t *m_signature = nullptr; /**< the default signature of all PNG files*/
-        uint8_t *m_pixelBuffer = nullptr; /**< the raw pixels buffer that should contain the PNG file*/
+        static constexpr uint8_t signature[8] = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A}; /**< the default signature of all PNG files*/
+        std::shared_ptr<uint8_t[]> m_pixelBuffer; /**< the raw pixels buffer, shared between copies until one of them changes its pixels */
 
         /** PNG CHUNKS objets : criticals(IHDR, IDAT, IEND) Optionals(pHYs)*/
         IHDR_CHUNK *m_IHDR = nullptr;
         PHYS_CHUNK *m_pHYs = nullptr;
-        IDAT_CHUNK *m_IDAT = nullptr;
+        std::shared_ptr<IDAT_CHUNK> m_IDAT; /**< the encoded scanlines, built on the first save, shared between copies until the pixels change */
         IEND_CHUNK *m_IEND = nullptr;
+        std::shared_ptr<PLTE_CHUNK> m_PLTE; /**< the palette of the encoded scanlines, nullptr if they are not palette indices */
+        std::shared_ptr<TRNS_CHUNK> m_tRNS; /**< the alpha values of the palette, nullptr if all its colors are opaque */
+
+        EncodeOptions m_options; /**< the options used for encoding the scanlines */
         
-        uint8_t *unfilter_line(const uint8_t *line_in, int lineLength, uint8_t filterMode, bool is_prev_line, const uint8_t *unfiltered_prev_line, uint8_t colorChannel);
-        uint8_t *readPixels(const std::string &path, int &s_width, int &s_height, uint8_t &bitDepth, uint8_t &colorMode, uint8_t &colorChannel, int &pixelsBufferLen, int &ppuX, int &ppuY, uint8_t &unitSpecifier);
+        PNG(const ChunkWalker &chunks, const std::string &source, const DecodeOptions &options);
+
+        void encode();
+        bool encode_palette();
+        void swap(PNG &png) noexcept;
+
+        using Reader = std::function<std::size_t(std::size_t offset, uint8_t *out, std::size_t len)>;
+        static Info probe(const Reader &read, const std::string &source, bool physical);
+        static Info read_info(const ChunkWalker &chunks, const std::string &source);
+        static Info decoded_info(const Info &info, const DecodeOptions &options);
+        static void read_pixels(const ChunkWalker &chunks, const Info &info, const DecodeOptions &options, const std::string &source, uint8_t *buffer, std::size_t stride);
+        static Info decode_into(const ChunkWalker &chunks, const std::string &source, uint8_t *buffer, std::size_t bufferLen, std::size_t stride, const DecodeOptions &options);
+        static Info decode_into(const ChunkWalker &chunks, const std::string &source, ImageView<uint16_t> image, const DecodeOptions &options);
 };
 
 
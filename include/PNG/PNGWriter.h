@@ -0,0 +1,67 @@
+#ifndef _PNG_WRITER_H_INCLUDED_
+#define _PNG_WRITER_H_INCLUDED_
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+
+#include "../zlib/zlib.h"
+#include "EncodeOptions.h"
+#include "OutputSink.h"
+
+/**
+ * @brief PNGWriter class, streaming png encoder.
+ * @details the signature and the IHDR chunk are written at construction, then pixels rows are filtered and deflated
+ * as soon as they are given, and the deflated datas are flushed as fixed size IDAT chunks. Only the previous row,
+ * a scanline and an IDAT chunk buffer stay resident, whatever the image size is.
+ * @see PNG for encoding a whole pixels buffer
+ *
+ */
+class PNGWriter
+{
+    public :
+        PNGWriter(const std::string &path, int s_width, int s_height, int bitDepth, int colorMode, const EncodeOptions &options = EncodeOptions(), int chunkSize = defaultChunkSize);
+        ~PNGWriter();
+
+        PNGWriter(const PNGWriter &) = delete;
+        PNGWriter &operator=(const PNGWriter &) = delete;
+
+        void write_rows(const uint8_t *rows, int rowNumber);
+        void finish();
+
+        int get_written_rows() const noexcept;
+
+        static constexpr int defaultChunkSize = 64 * 1024; /**< the default IDAT chunks datas length */
+
+    private :
+        FileSink *m_sink = nullptr; /**< the output png file */
+        z_stream m_stream; /**< the deflate stream, fed with the filtered scanlines */
+        bool m_finished = false; /**< if the IEND chunk has been written */
+
+        EncodeOptions m_options; /**< the encoding options */
+        int m_height; /**< the png height */
+        int m_colorChannel; /**< bytes per pixel, distance used by filters */
+        int m_lineLength; /**< the row length, without filter byte */
+        int m_rows = 0; /**< the number of rows already written */
+
+        std::vector<uint8_t> m_prevLine; /**< the previous (unfiltered) row, a row of 0 before the first row */
+        std::vector<uint8_t> m_scanline; /**< the filtered scanline, filter mode byte first */
+        uint8_t m_filterMode = 0x0; /**< the filter mode of the last row, reused by Filters::Selection::ADAPTIVE_FAST */
+
+        z_stream m_trialStream; /**< deflate stream used by Filters::Selection::BRUTE_FORCE */
+        bool m_trialInitialised = false; /**< if m_trialStream is initialised, only for Filters::Selection::BRUTE_FORCE */
+        std::vector<uint8_t> m_trialDatas; /**< trial deflate output, for Filters::Selection::BRUTE_FORCE */
+
+        std::vector<uint8_t> m_chunk; /**< the IDAT chunk being filled : type then datas, so that its crc32 needs no copy */
+        int m_chunkSize; /**< the IDAT chunks datas length */
+
+        void release() noexcept;
+        uint8_t select_filter(const uint8_t *line, const uint8_t *prev_line);
+        void deflate_scanline(int flush);
+        void flush_chunk();
+        void write_chunk(const uint8_t *typeAndDatas, int dataLen);
+};
+
+#endif //_PNG_WRITER_H_INCLUDED_
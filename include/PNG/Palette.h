@@ -0,0 +1,48 @@
+#ifndef _PALETTE_H_INCLUDED_
+#define _PALETTE_H_INCLUDED_
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * @brief Palette class, palette (indexed color) encoding of 8 bits RGB and RGBA pixels.
+ * @details the distinct colors are collected in a small open addressing hash table, up to 256 colors. RGB images with
+ * more colors can be quantized : the palette is then made of the dominant colors of a pixels sample (k-means clustering),
+ * and each pixel gets the index of its nearest palette color.
+ * @see PixelsManager::get_dominants_colors_kmean
+ *
+ */
+class Palette
+{
+    public :
+        Palette(const uint8_t *pixels, int pixelNumber, int colorChannel, bool quantize, int iterations);
+
+        bool is_valid() const noexcept;
+        int get_entries() const noexcept;
+        int get_transparent_entries() const noexcept;
+        void get_colors(uint8_t *rgb) const noexcept;
+        void get_alphas(uint8_t *alphas) const noexcept;
+
+        std::vector<uint8_t> index_pixels(const uint8_t *pixels, int s_width, int s_height, uint8_t bitDepth) const;
+
+        static constexpr int maxEntries = 256; /**< the maximum number of palette entries */
+        static constexpr int maxSample = 65536; /**< the maximum number of pixels given to the clustering */
+
+    private :
+        static constexpr int hashSize = 1024; /**< the size of the colors hash table, a power of 2 */
+
+        int m_colorChannel; /**< the number of bytes per pixel, 3 (RGB) or 4 (RGBA) */
+        bool m_exact = false; /**< true if the palette contains all the pixels colors */
+        std::vector<uint32_t> m_colors; /**< the palette colors, RGBA packed as r | g << 8 | b << 16 | a << 24 */
+        uint32_t m_keys[hashSize]; /**< the colors of the hash table */
+        int16_t m_indices[hashSize]; /**< the palette index of each color of the hash table, -1 for an empty slot */
+
+        static uint32_t get_color(const uint8_t *pixel, int colorChannel) noexcept;
+        static uint32_t hash(uint32_t color) noexcept;
+        int find(uint32_t color) const noexcept;
+        void insert(uint32_t color, int index) noexcept;
+        int nearest(uint32_t color) const noexcept;
+};
+
+#endif //_PALETTE_H_INCLUDED_
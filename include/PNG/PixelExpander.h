@@ -0,0 +1,40 @@
+#ifndef _PIXEL_EXPANDER_H_INCLUDED_
+#define _PIXEL_EXPANDER_H_INCLUDED_
+
+#include <cstdint>
+#include <stdexcept>
+
+#include "ChunkWalker.h"
+
+/**
+ * @brief PixelExpander class, expansion of the packed scanlines (1, 2 or 4 bits samples, palette indices) to 8 bits samples.
+ * @details grayscale samples are scaled to 8 bits, palette indices are replaced by their RGB color, or RGBA color when
+ * the png has a tRNS chunk. Each packed byte is unpacked with a single table lookup, and each palette color is copied
+ * with a single 32 bits store.
+ *
+ */
+class PixelExpander
+{
+    public :
+        PixelExpander(uint8_t bitDepth, uint8_t colorMode, const ChunkWalker::Chunk *palette, const ChunkWalker::Chunk *transparency);
+
+        void expand_line(uint8_t *line_out, const uint8_t *line, int width) const noexcept;
+
+        uint8_t get_colorMode() const noexcept;
+        uint8_t get_colorChannel() const noexcept;
+
+        static bool is_packed(uint8_t bitDepth, uint8_t colorMode) noexcept;
+        static int get_lineLength(int width, uint8_t bitDepth, uint8_t colorMode) noexcept;
+
+    private :
+        uint8_t m_bitDepth; /**< the bit depth of the packed samples : 1, 2, 4 or 8 (palette only) */
+        uint8_t m_colorMode; /**< the color mode of the packed samples : 0 (grayscale) or 3 (palette) */
+        uint8_t m_colorChannel; /**< the number of bytes of the expanded pixels : 1 (grayscale), 3 (RGB) or 4 (RGBA) */
+        uint8_t m_unpack[256][8]; /**< the samples of each packed byte, scaled to 8 bits for grayscale */
+        uint8_t m_palette[256][4]; /**< the RGBA colors of the palette, opaque black for the missing entries */
+
+        template <int colorChannel>
+        void expand_palette(uint8_t *line_out, const uint8_t *line, int width) const noexcept;
+};
+
+#endif //_PIXEL_EXPANDER_H_INCLUDED_
@@ -0,0 +1,43 @@
+#ifndef _SCANLINE_DECODER_H_INCLUDED_
+#define _SCANLINE_DECODER_H_INCLUDED_
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+#include "../zlib/zlib.h"
+#include "ChunkWalker.h"
+
+/**
+ * @brief ScanlineDecoder class, streaming inflate and unfilter of the IDAT chunks datas.
+ * @details IDAT datas are fed chunk by chunk into a single z_stream, and each scanline is inflated
+ * directly in its destination then unfiltered in place. Only the previous unfiltered line needs to stay resident.
+ *
+ */
+class ScanlineDecoder
+{
+    public :
+        ScanlineDecoder(const std::vector<const ChunkWalker::Chunk *> &datas, int lineLength, int colorChannel);
+        ~ScanlineDecoder();
+
+        ScanlineDecoder(const ScanlineDecoder &) = delete;
+        ScanlineDecoder &operator=(const ScanlineDecoder &) = delete;
+
+        void next_line(uint8_t *line_out);
+        void next_pass(int lineLength);
+
+    private :
+        z_stream m_stream; /**< the inflate stream, fed with IDAT chunks datas */
+        std::vector<const ChunkWalker::Chunk *> m_datas; /**< the IDAT chunks, in file order */
+        std::size_t m_nextData = 0; /**< index of the next IDAT chunk to feed into the stream */
+
+        int m_lineLength; /**< the unfiltered line length (without filter byte) */
+        int m_maxLineLength; /**< the length of the longest line, the length of the zero line */
+        int m_colorChannel; /**< bytes per pixel, distance used by filters */
+        const uint8_t *m_prevLine = nullptr; /**< the previous unfiltered line, nullptr for the first line */
+        uint8_t *m_zeroLine = nullptr; /**< a line of 0, acting as the previous line of the first line */
+
+        void inflate_to(uint8_t *out, int len);
+};
+
+#endif //_SCANLINE_DECODER_H_INCLUDED_
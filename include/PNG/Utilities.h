@@ -18,6 +18,8 @@ namespace Utilities
 
     uint8_t *int_to_uint8(int number);
     int uint8_to_int(uint8_t *ptr);
+    uint32_t read_be32(const uint8_t *ptr) noexcept;
+    void write_be32(uint8_t *ptr, uint32_t value) noexcept;
 
     uint8_t *invertArray(uint8_t *array, int len);
     uint8_t *getConcatenedArray(uint8_t *array1, uint8_t *array2, int len1, int len2);
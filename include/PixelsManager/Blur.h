@@ -0,0 +1,25 @@
+#ifndef _BLUR_H_INCLUDED_
+#define _BLUR_H_INCLUDED_
+
+#include <cstdint>
+#include <stdexcept>
+
+#include "../PNG/ImageView.h"
+
+/**
+ * @namespace Blur
+ * @brief blur engines working on ImageView images (uint8_t, uint16_t or float samples, 1 to 4 channels, padded rows).
+ * @details the box blur is separable and uses running sums : its cost per pixel doesn't depend on the radius.
+ * The gaussian blur is separable too, with a precomputed 1D kernel, and uses stacked box blurs for large sigmas.
+ * The images are split in bands of rows, blurred in parallel.
+ */
+namespace Blur
+{
+    template <typename T>
+    void box(ImageView<const typename ImageView<T>::sample_type> image_in, ImageView<T> image_out, int radius, int passes = 1, int threads = 0);
+
+    template <typename T>
+    void gaussian(ImageView<const typename ImageView<T>::sample_type> image_in, ImageView<T> image_out, float sigma, int radius = 0, int threads = 0);
+};
+
+#endif //_BLUR_H_INCLUDED_
@@ -0,0 +1,55 @@
+#ifndef _COLOR_STATS_H_INCLUDED_
+#define _COLOR_STATS_H_INCLUDED_
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * @namespace ColorStats
+ * @brief colors statistics of rgb buffers : distinct colors and their occurrences.
+ * @details the colors are packed in 24 bits keys (0xRRGGBB). Large buffers are counted in a flat array of 2^24 counters,
+ * small ones in an open addressing hash table growing with the colors, the method is chosen from the pixels number.
+ */
+namespace ColorStats
+{
+    /**
+     * @struct ColorCount
+     * @brief a packed color and its number of occurrences
+     */
+    struct ColorCount
+    {
+        uint32_t key; /**< the color, 0xRRGGBB */
+        uint32_t count; /**< the number of pixels of this color */
+    };
+
+    /**
+     * @brief pack a rgb pixel in a 24 bits key
+     *
+     * @param rgb the pixel red, green and blue samples
+     * @return uint32_t the key, 0xRRGGBB
+     */
+    inline uint32_t pack(const uint8_t *rgb) noexcept
+    {
+        return (static_cast<uint32_t>(rgb[0]) << 16) | (static_cast<uint32_t>(rgb[1]) << 8) | rgb[2];
+    }
+
+    /**
+     * @brief unpack a 24 bits key in a rgb pixel
+     *
+     * @param key the key, 0xRRGGBB
+     * @param rgb the pixel red, green and blue samples
+     */
+    inline void unpack(uint32_t key, uint8_t *rgb) noexcept
+    {
+        rgb[0] = static_cast<uint8_t>(key >> 16);
+        rgb[1] = static_cast<uint8_t>(key >> 8);
+        rgb[2] = static_cast<uint8_t>(key);
+    }
+
+    std::vector<ColorCount> count(const uint8_t *rgb_in, std::size_t pixels);
+    std::size_t distinct(const uint8_t *rgb_in, std::size_t pixels);
+    void most_frequent(std::vector<ColorCount> &colors, std::size_t n);
+};
+
+#endif //_COLOR_STATS_H_INCLUDED_
@@ -0,0 +1,35 @@
+#ifndef _HISTOGRAM_H_INCLUDED_
+#define _HISTOGRAM_H_INCLUDED_
+
+#include <limits>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+#include "../PNG/ImageView.h"
+
+/**
+ * @namespace Histogram
+ * @brief histogram engine for uint8_t and uint16_t samples, and the statistics computed from histograms.
+ * @details the samples are counted in a single pass : the images are split in bands of rows counted in parallel, each band
+ * counts 8 bits samples in several sub-histograms so that equal consecutive samples don't wait for each other.
+ * Images have one histogram per channel and can be masked, a region of interest is a view of the region (see ImageView::region).
+ */
+namespace Histogram
+{
+    /**
+     * @brief number of bins of the histograms of a sample type : 256 for 8 bits samples, 65536 for 16 bits samples
+     */
+    template <typename T>
+    constexpr std::size_t levels = static_cast<std::size_t>(std::numeric_limits<T>::max()) + 1;
+
+    template <typename T>
+    std::vector<uint64_t> compute(const T *samples, std::size_t len, int threads = 0);
+
+    template <typename T>
+    std::vector<uint64_t> compute(ImageView<const T> image, ImageView<const uint8_t> mask = ImageView<const uint8_t>(), int threads = 0);
+
+    std::size_t otsu_threshold(const uint64_t *histogram, std::size_t bins);
+};
+
+#endif //_HISTOGRAM_H_INCLUDED_
@@ -0,0 +1,63 @@
+#ifndef _KMEANS_H_INCLUDED_
+#define _KMEANS_H_INCLUDED_
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * @namespace KMeans
+ * @brief k-means clustering of weighted 3D points (rgb colors for instance).
+ * @details the points are stored by coordinate, the nearest centroids of a block of points are searched centroid by centroid
+ * in vectorised loops. The centroids are seeded with k-means++, the iterations stop when the centroids don't move anymore.
+ * The points are split in bands, assigned and summed in parallel.
+ */
+namespace KMeans
+{
+    /**
+     * @struct Points
+     * @brief points of 3 coordinates stored by coordinate (structure of arrays), with a weight per point
+     */
+    struct Points
+    {
+        std::vector<float> x; /**< the first coordinate of each point */
+        std::vector<float> y; /**< the second coordinate of each point */
+        std::vector<float> z; /**< the third coordinate of each point */
+        std::vector<float> weights; /**< the weight of each point, the number of pixels of a color for instance */
+
+        /**
+         * @brief add a point
+         *
+         * @param px the first coordinate
+         * @param py the second coordinate
+         * @param pz the third coordinate
+         * @param weight the point weight, positive
+         */
+        void push_back(float px, float py, float pz, float weight = 1.0f)
+        {
+            x.push_back(px);
+            y.push_back(py);
+            z.push_back(pz);
+            weights.push_back(weight);
+        }
+
+        std::size_t size() const noexcept { return x.size(); }
+    };
+
+    /**
+     * @struct Clustering
+     * @brief result of a clustering
+     */
+    struct Clustering
+    {
+        std::vector<float> centroids; /**< the 3 coordinates of each centroid */
+        std::vector<double> weights; /**< the sum of the weights of the points of each cluster, 0 for an empty cluster */
+        std::vector<int> labels; /**< the cluster of each point, the one of its nearest centroid */
+        std::vector<float> distances; /**< the squared distance of each point to its centroid */
+        int iterations = 0; /**< the number of iterations done */
+    };
+
+    Clustering cluster(const Points &points, int clusters, int iters, float tolerance = 0.25f, int threads = 0, uint32_t seed = 91);
+};
+
+#endif //_KMEANS_H_INCLUDED_
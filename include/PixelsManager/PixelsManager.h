@@ -15,10 +15,16 @@
 #include <algorithm>
 #include <exception>
 #include <functional>
+#include <limits>
+#include <type_traits>
+
+#include "../PNG/ImageView.h"
 
 /**
  * @namespace PixelsManager 
  * @brief a set of usefull method for managing, transforming and manipulating pixels buffer
+ * @details the templated methods are instantiated for uint8_t, uint16_t (native byte order, see PNG::decode_into) and float samples,
+ * they also exist for ImageView images (padded rows, 1 to 4 channels).
  */
 namespace PixelsManager
 {
@@ -34,14 +40,15 @@ namespace PixelsManager
      * Algorithms
      */
 
-    uint8_t *grayscale_to_otsu(const uint8_t *gray_in, int gray_len, int &bin_len); // Otsu Nobuyuki Algorithm for Binarisation
+    template <typename T> T *grayscale_to_otsu(const T *gray_in, int gray_len, int &bin_len); // Otsu Nobuyuki Algorithm for Binarisation
     uint8_t *get_dominants_colors_kmean(const uint8_t *rgb_in, int rgb_len, int nb_colors, int iters, int &nb_colors_out); // Kmean clustering Algorithm for color detection
 
     /*
      * Color Mode Management
      */
 
-    uint8_t *rgb_to_grayscale(const uint8_t *rgb_in, int rgb_len, int mode, int &gray_len); 
+    template <typename T> T *rgb_to_grayscale(const T *rgb_in, int rgb_len, int mode, int &gray_len);
+    template <typename T> void rgb_to_grayscale(ImageView<const typename ImageView<T>::sample_type> rgb_in, ImageView<T> gray_out, int mode);
     uint8_t *rgb_to_channel(const uint8_t *rgb_in, int rgb_len, int channel, int &ch_len);
     uint8_t *rgb_to_channel_s(const uint8_t *rgb_in, int rgb_len, int channel, int &ch_len);
     uint8_t *rgba_to_rgb(const uint8_t *rgba_buffer, int bufferLen, int &rgb_len);
@@ -52,7 +59,7 @@ namespace PixelsManager
      * Color buffer Analysis 
      */
 
-    inline std::vector<int> getHistogram(const uint8_t *buffer_in, int buffer_len) noexcept;
+    std::vector<int> getHistogram(const uint8_t *buffer_in, int buffer_len);
     uint8_t *get_high_occ_colors(const uint8_t *rgb_in, int rgb_len, int nb_colors);
     int get_nb_colors(const uint8_t *rgb_in, int rgb_len);
 
@@ -65,8 +72,10 @@ namespace PixelsManager
     uint8_t *lut_to_rgb_thread(const uint8_t *gray_in, int gray_len, const uint8_t *rgb_lut, int lut_len, int thread_number);
     uint8_t *overscreen_color(const uint8_t *rgb_in, int rgb_len, const uint8_t *rgb_toscreen, int rgb_toscreen_len);
     
-    uint8_t *blur(const uint8_t *rgb_in, int rgb_len, int s_width, int s_height, int side_neigbours);
-    uint8_t *gaussian_blur(const uint8_t *rgb_in, int rgb_len, int s_width, int s_height, int side_neigbours, float sigma);
+    template <typename T> T *blur(const T *rgb_in, int rgb_len, int s_width, int s_height, int side_neigbours, int passes = 1);
+    template <typename T> void blur(ImageView<const typename ImageView<T>::sample_type> image_in, ImageView<T> image_out, int side_neigbours, int passes = 1);
+    template <typename T> T *gaussian_blur(const T *rgb_in, int rgb_len, int s_width, int s_height, int side_neigbours, float sigma);
+    template <typename T> void gaussian_blur(ImageView<const typename ImageView<T>::sample_type> image_in, ImageView<T> image_out, int side_neigbours, float sigma);
     /**
      * @namespace gray_level
      */
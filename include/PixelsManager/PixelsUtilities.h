@@ -2,6 +2,7 @@
 #define _PIXELS_UTILITIES_H_INCLUDED_
 
 #include <cmath>
+#include <thread>
 #include <vector>
 #include <numeric>
 #include <iostream>
@@ -60,6 +61,41 @@ namespace PixelsUtilities
     void kMeansClustering(std::vector<PixelsUtilities::Kmean_point> &points, int iters, int nb_clusters);
     uint8_t *get_rgb_part(const uint8_t *rgb_in, int rgb_len, int s_width, int s_height, int x_start, int y_start, int x_end, int y_end);
 
+
+    /*
+     * Threading methods
+     */
+
+    /**
+     * @brief run a task function for each task index : the first task in the calling thread, the others in new threads
+     * @warning the task function mustn't throw, it's called in threads.
+     *
+     * @param tasks the number of tasks
+     * @param task the task function, called with the task index
+     *
+     * @exception std::system_error if a thread cannot be started
+     */
+    template <typename Function>
+    void run_parallel(int tasks, const Function &task)
+    {
+        std::vector<std::thread> workers;
+        try
+        {
+            for (int index = 1; index < tasks; ++index)
+                workers.emplace_back(std::cref(task), index);
+        }
+        catch (const std::exception &)
+        {
+            for (auto &worker : workers)
+                worker.join();
+            throw;
+        }
+
+        if (tasks > 0)
+            task(0);
+        for (auto &worker : workers)
+            worker.join();
+    }
 };
 
 #endif //_PIXELS_UTILITIES_H_INCLUDED_
\ No newline at end of file
@@ -11,6 +11,20 @@ g++^
  "bin/link/IEND_CHUNK.o" ^
  "bin/link/PNG.o" ^
  "bin/link/Utilities.o" ^
+ "bin/link/ChunkWalker.o" ^
+ "bin/link/ScanlineDecoder.o" ^
+ "bin/link/Filters.o" ^
+ "bin/link/PNGWriter.o" ^
+ "bin/link/OutputSink.o" ^
+ "bin/link/PixelExpander.o" ^
+ "bin/link/PLTE_CHUNK.o" ^
+ "bin/link/TRNS_CHUNK.o" ^
+ "bin/link/Palette.o" ^
+ "bin/link/Adam7.o" ^
+ "bin/link/Blur.o" ^
+ "bin/link/Histogram.o" ^
+ "bin/link/ColorStats.o" ^
+ "bin/link/KMeans.o" ^
  -o "./bin/output.exe"^
  -L"./lib" -m32 -lopengl32 -lglut32 -lz
 
@@ -0,0 +1,147 @@
+#include <cstring>
+
+#include "../../include/PNG/Adam7.h"
+
+namespace
+{
+    // first column, first row, column step and row step of each pass
+    constexpr int xStart[Adam7::passNumber] = {0, 4, 0, 2, 0, 1, 0};
+    constexpr int yStart[Adam7::passNumber] = {0, 0, 4, 0, 2, 0, 1};
+    constexpr int xStep[Adam7::passNumber] = {8, 8, 4, 4, 2, 2, 1};
+    constexpr int yStep[Adam7::passNumber] = {8, 8, 8, 4, 4, 2, 2};
+
+    // the grid of the decoded pixels once a pass is done, pixels (x, y) with x % xGrid == 0 and y % yGrid == 0
+    constexpr int xGrid[Adam7::passNumber] = {8, 4, 4, 2, 2, 1, 1};
+    constexpr int yGrid[Adam7::passNumber] = {8, 8, 4, 4, 2, 2, 1};
+
+    /**
+     * @brief scatter the pixels of a pass line, the pixel size being known at compile time
+     *
+     * @tparam bytesPerPixel the number of bytes per pixel
+     * @param row the destination row, its first pixel of the pass
+     * @param line the pass line
+     * @param pixels the number of pixels of the pass line
+     * @param step the distance between two pixels of the pass line in the row, in pixels
+     */
+    template <int bytesPerPixel>
+    void scatter(uint8_t *row, const uint8_t *line, int pixels, int step) noexcept
+    {
+        const std::size_t distance = static_cast<std::size_t>(step) * bytesPerPixel;
+        for (int i = 0; i < pixels; ++i, row += distance, line += bytesPerPixel)
+            std::memcpy(row, line, bytesPerPixel);
+    }
+}
+
+/**
+ * @brief get the number of pixels of the lines of a pass
+ *
+ * @param pass the pass, from 0 to 6
+ * @param width the image width
+ * @return int the pass width, 0 if the pass is empty
+ */
+int Adam7::get_passWidth(int pass, int width) noexcept
+{
+    return (width > xStart[pass]) ? (width - xStart[pass] + xStep[pass] - 1) / xStep[pass] : 0;
+}
+
+/**
+ * @brief get the number of lines of a pass
+ *
+ * @param pass the pass, from 0 to 6
+ * @param height the image height
+ * @return int the pass height, 0 if the pass is empty
+ */
+int Adam7::get_passHeight(int pass, int height) noexcept
+{
+    return (height > yStart[pass]) ? (height - yStart[pass] + yStep[pass] - 1) / yStep[pass] : 0;
+}
+
+/**
+ * @brief get the image row of a pass line
+ *
+ * @param pass the pass, from 0 to 6
+ * @param line the line of the pass
+ * @return int the row in the image
+ */
+int Adam7::get_passRow(int pass, int line) noexcept
+{
+    return yStart[pass] + line * yStep[pass];
+}
+
+/**
+ * @brief get the last pass needed for an image reduced by a scale
+ * @details once this pass is decoded, all the pixels (x, y) with x % scale == 0 and y % scale == 0 are decoded.
+ *
+ * @param scale the reduction factor : 1, 2, 4 or 8
+ * @return int the pass, from 0 to 6
+ */
+int Adam7::get_gridPass(int scale) noexcept
+{
+    int pass = 0;
+    while (pass < passNumber - 1 && (xGrid[pass] > scale || yGrid[pass] > scale))
+        ++pass;
+    return pass;
+}
+
+/**
+ * @brief scatter the pixels of a pass line in their image row
+ * @details with a scale, the row is a row of the grid image : only the pixels (x, y) with x % scale == 0 and y % scale == 0,
+ * stored at (x / scale, y / scale). The pass must be at most get_gridPass(scale).
+ *
+ * @param row the image row
+ * @param line the unfiltered pass line, 8 or 16 bits samples
+ * @param pass the pass, from 0 to 6
+ * @param width the image width
+ * @param bytesPerPixel the number of bytes per pixel, from 1 to 8
+ * @param scale the grid step of the image : 1, 2, 4 or 8
+ */
+void Adam7::scatter_line(uint8_t *row, const uint8_t *line, int pass, int width, int bytesPerPixel, int scale) noexcept
+{
+    uint8_t *first = row + static_cast<std::size_t>(xStart[pass] / scale) * bytesPerPixel;
+    const int pixels = get_passWidth(pass, width), step = xStep[pass] / scale;
+
+    switch (bytesPerPixel)
+    {
+        case 1 : scatter<1>(first, line, pixels, step); break;
+        case 2 : scatter<2>(first, line, pixels, step); break;
+        case 3 : scatter<3>(first, line, pixels, step); break;
+        case 4 : scatter<4>(first, line, pixels, step); break;
+        case 6 : scatter<6>(first, line, pixels, step); break;
+        case 8 : scatter<8>(first, line, pixels, step); break;
+        default :
+            for (int i = 0; i < pixels; ++i)
+                std::memcpy(first + static_cast<std::size_t>(i) * step * bytesPerPixel, line + static_cast<std::size_t>(i) * bytesPerPixel, bytesPerPixel);
+    }
+}
+
+/**
+ * @brief fill the pixels of the passes following a pass with the decoded pixels, giving a coarse image
+ * @details each missing pixel is a copy of the decoded pixel at the top left of its block.
+ *
+ * @param image the image, the pixels of the passes up to lastPass are decoded
+ * @param stride the distance between two image rows, in bytes
+ * @param width the image width, the grid image width with a scale
+ * @param height the image height, the grid image height with a scale
+ * @param bytesPerPixel the number of bytes per pixel
+ * @param lastPass the last decoded pass, from 0 to 6, at most get_gridPass(scale)
+ * @param scale the grid step of the image (see scatter_line) : 1, 2, 4 or 8
+ */
+void Adam7::fill_missing(uint8_t *image, std::size_t stride, int width, int height, int bytesPerPixel, int lastPass, int scale) noexcept
+{
+    const int xCell = xGrid[lastPass] / scale, yCell = yGrid[lastPass] / scale;
+    const std::size_t rowBytes = static_cast<std::size_t>(width) * bytesPerPixel;
+
+    for (int y = 0; y < height; ++y)
+    {
+        uint8_t *row = image + y * stride;
+        if (y % yCell != 0) // rows without decoded pixels are copies of the previous decoded row
+        {
+            std::memcpy(row, image + (y - y % yCell) * stride, rowBytes);
+            continue;
+        }
+
+        for (int x = 0; x < width; ++x)
+            if (x % xCell != 0)
+                std::memcpy(row + static_cast<std::size_t>(x) * bytesPerPixel, row + static_cast<std::size_t>(x - x % xCell) * bytesPerPixel, bytesPerPixel);
+    }
+}
@@ -1,60 +1,332 @@
-
 #include "../../include/PNG/CRC32.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define CRC32_X86_SIMD 1
+    #include <immintrin.h>
+#endif
+
 
 bool CRC32::crc_table_computed = false; //static bool for test if the table is already computes or not
 uint32_t CRC32::crc_table[256];    //crc table static var exempt recomputation many crc_table recompution
 
+namespace
+{
+    constexpr uint32_t polynomial = 0xedb88320u; // reflected crc32 polynomial
+
+    /*
+     * slice-by-8 tables : tables[k][n] is the crc of the byte n followed by k zero bytes,
+     * so that 8 bytes are processed with 8 independent lookups.
+     */
+    struct Tables
+    {
+        uint32_t slices[8][256];
+
+        Tables() noexcept
+        {
+            for (uint32_t n = 0; n < 256; ++n)
+            {
+                uint32_t c = n;
+                for (int j = 0; j < 8; ++j)
+                    c = (c & 1) ? polynomial ^ (c >> 1) : c >> 1;
+                slices[0][n] = c;
+            }
+            for (uint32_t n = 0; n < 256; ++n)
+                for (int k = 1; k < 8; ++k)
+                    slices[k][n] = slices[0][slices[k - 1][n] & 0xff] ^ (slices[k - 1][n] >> 8);
+        }
+    };
+
+    const Tables &get_tables() noexcept
+    {
+        static const Tables tables; // thread safe initialisation
+        return tables;
+    }
+
+    // the kernels work on the crc register (not inverted)
+    using crc_kernel = uint32_t (*)(uint32_t crc, const uint8_t *datas, std::size_t len);
+
+    uint32_t bytewise(uint32_t crc, const uint8_t *datas, std::size_t len)
+    {
+        const uint32_t *table = get_tables().slices[0];
+        for (std::size_t i = 0; i < len; ++i)
+            crc = table[(crc ^ datas[i]) & 0xff] ^ (crc >> 8);
+        return crc;
+    }
+
+    uint32_t slice_by_8(uint32_t crc, const uint8_t *datas, std::size_t len)
+    {
+        const auto &t = get_tables().slices;
+        for (; len >= 8; datas += 8, len -= 8)
+        {
+            uint32_t low = crc ^ (static_cast<uint32_t>(datas[0]) | static_cast<uint32_t>(datas[1]) << 8 | static_cast<uint32_t>(datas[2]) << 16 | static_cast<uint32_t>(datas[3]) << 24);
+            uint32_t high = static_cast<uint32_t>(datas[4]) | static_cast<uint32_t>(datas[5]) << 8 | static_cast<uint32_t>(datas[6]) << 16 | static_cast<uint32_t>(datas[7]) << 24;
+            crc = t[7][low & 0xff] ^ t[6][(low >> 8) & 0xff] ^ t[5][(low >> 16) & 0xff] ^ t[4][low >> 24] ^
+                  t[3][high & 0xff] ^ t[2][(high >> 8) & 0xff] ^ t[1][(high >> 16) & 0xff] ^ t[0][high >> 24];
+        }
+        return bytewise(crc, datas, len);
+    }
+
+#ifdef CRC32_X86_SIMD
+
+    // folding a 128 bits block into the next one
+    __attribute__((target("pclmul,sse4.1"))) inline __m128i fold(__m128i x, __m128i next, __m128i k)
+    {
+        __m128i low = _mm_clmulepi64_si128(x, k, 0x00);
+        return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x11), next), low);
+    }
+
+    /*
+     * carry-less multiplication kernel, folding 4 x 128 bits blocks at once then reducing to 32 bits (Barrett reduction).
+     * See "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction" (Intel), the constants
+     * are the bit-reflected ones for the crc32 polynomial.
+     */
+    __attribute__((target("pclmul,sse4.1"))) uint32_t pclmul_blocks(uint32_t crc, const uint8_t *datas, std::size_t len)
+    {
+        alignas(16) static const uint64_t k1k2[] = {0x0154442bd4, 0x01c6e41596};
+        alignas(16) static const uint64_t k3k4[] = {0x01751997d0, 0x00ccaa009e};
+        alignas(16) static const uint64_t k5k0[] = {0x0163cd6124, 0x0000000000};
+        alignas(16) static const uint64_t poly[] = {0x01db710641, 0x01f7011641};
+
+        // len is a multiple of 16, at least 64
+        __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(datas + 0x00));
+        __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(datas + 0x10));
+        __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(datas + 0x20));
+        __m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(datas + 0x30));
+        x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+
+        __m128i k = _mm_load_si128(reinterpret_cast<const __m128i *>(k1k2));
+        datas += 64;
+        len -= 64;
+
+        for (; len >= 64; datas += 64, len -= 64) // parallel fold of 64 bytes blocks
+        {
+            __m128i x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+            __m128i x6 = _mm_clmulepi64_si128(x2, k, 0x00);
+            __m128i x7 = _mm_clmulepi64_si128(x3, k, 0x00);
+            __m128i x8 = _mm_clmulepi64_si128(x4, k, 0x00);
+
+            x1 = _mm_clmulepi64_si128(x1, k, 0x11);
+            x2 = _mm_clmulepi64_si128(x2, k, 0x11);
+            x3 = _mm_clmulepi64_si128(x3, k, 0x11);
+            x4 = _mm_clmulepi64_si128(x4, k, 0x11);
+
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i *>(datas + 0x00)));
+            x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i *>(datas + 0x10)));
+            x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i *>(datas + 0x20)));
+            x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i *>(datas + 0x30)));
+        }
+
+        // folding the 4 blocks into 128 bits, then the remaining 16 bytes blocks
+        k = _mm_load_si128(reinterpret_cast<const __m128i *>(k3k4));
+        x1 = fold(x1, x2, k);
+        x1 = fold(x1, x3, k);
+        x1 = fold(x1, x4, k);
+        for (; len >= 16; datas += 16, len -= 16)
+            x1 = fold(x1, _mm_loadu_si128(reinterpret_cast<const __m128i *>(datas)), k);
+
+        // folding 128 bits to 64 bits
+        const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+        x2 = _mm_clmulepi64_si128(x1, k, 0x10);
+        x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+        k = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(k5k0));
+        x2 = _mm_srli_si128(x1, 4);
+        x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x00), x2);
+
+        // Barrett reduction to 32 bits
+        k = _mm_load_si128(reinterpret_cast<const __m128i *>(poly));
+        x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x10);
+        x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask32), k, 0x00);
+        x1 = _mm_xor_si128(x1, x2);
+
+        return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+    }
+
+    uint32_t pclmul(uint32_t crc, const uint8_t *datas, std::size_t len)
+    {
+        if (len >= 64)
+        {
+            std::size_t blocks = len & ~static_cast<std::size_t>(15);
+            crc = pclmul_blocks(crc, datas, blocks);
+            datas += blocks;
+            len -= blocks;
+        }
+        return slice_by_8(crc, datas, len);
+    }
+
+#endif // CRC32_X86_SIMD
+
+    CRC32::Engine get_supported_engine() noexcept
+    {
+#ifdef CRC32_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1"))
+            return CRC32::Engine::PCLMUL;
+#endif
+        return CRC32::Engine::SLICE_BY_8;
+    }
+
+    struct Kernel
+    {
+        CRC32::Engine engine;
+        crc_kernel update;
+    };
+
+    Kernel select_kernel(CRC32::Engine engine) noexcept
+    {
+        if (engine > get_supported_engine())
+            engine = get_supported_engine();
+
+        switch (engine)
+        {
+#ifdef CRC32_X86_SIMD
+        case CRC32::Engine::PCLMUL:
+            return {engine, pclmul};
+#endif
+        case CRC32::Engine::SLICE_BY_8:
+            return {engine, slice_by_8};
+        default:
+            return {CRC32::Engine::BYTEWISE, bytewise};
+        }
+    }
+
+    Kernel &get_kernel() noexcept
+    {
+        static Kernel kernel = select_kernel(get_supported_engine()); // best implementation for the running cpu
+        return kernel;
+    }
+
+    /*
+     * crc32 combination, multiplications of polynomials modulo the crc polynomial (see zlib crc32_combine).
+     */
+    uint32_t multmodp(uint32_t a, uint32_t b) noexcept
+    {
+        uint32_t m = 1u << 31, p = 0;
+        for (;;)
+        {
+            if (a & m)
+            {
+                p ^= b;
+                if ((a & (m - 1)) == 0)
+                    break;
+            }
+            m >>= 1;
+            b = (b & 1) ? (b >> 1) ^ polynomial : b >> 1;
+        }
+        return p;
+    }
+
+    // x^(n * 2^k) modulo the crc polynomial
+    uint32_t x2nmodp(std::size_t n, unsigned k) noexcept
+    {
+        static const struct Powers
+        {
+            uint32_t x2n[32]; // x^(2^i) modulo the crc polynomial
+            Powers() noexcept
+            {
+                uint32_t p = 1u << 30; // x^1
+                for (auto &power : x2n)
+                {
+                    power = p;
+                    p = multmodp(p, p);
+                }
+            }
+        } powers;
+
+        uint32_t p = 1u << 31; // x^0
+        for (; n != 0; n >>= 1, ++k)
+            if (n & 1)
+                p = multmodp(powers.x2n[k & 31], p);
+        return p;
+    }
+}
+
 /**
  * @brief crc calculation method
- * 
+ *
  * @param chunkDatas the buffer that crc32 should be performed on
  * @param chunkDatasLen the size of the input buffer (chunkDatas)
  * @return the crc32 calculated
  */
 uint32_t CRC32::getCRC32(uint8_t *chunkDatas, int chunkDatasLen)
 {
-    return CRC32_update(0xffffffffL, chunkDatas, chunkDatasLen) ^ 0xffffffffL;
+    return update(0, chunkDatas, static_cast<std::size_t>(chunkDatasLen));
 }
 
 /**
  * @brief crc table computing method
- * 
+ *
  */
 void CRC32::CRC32_table_compute()
 {
-    uint32_t c;
-    int i, j;
-    for (i = 0; i < 256; i++)
-    {
-        c = i;
-        for (j = 0; j < 8; j++)
-        {
-            if (c & 1)
-                c = 0xedb88320L ^ (c >> 1);
-            else
-                c = c >> 1;
-        }
-        crc_table[i] = c;
-    }
+    const uint32_t *table = get_tables().slices[0];
+    for (int i = 0; i < 256; i++)
+        crc_table[i] = table[i];
     crc_table_computed = true;
 }
 
 /**
- * @brief crc32 update method
- * 
- * @param crc 
- * @param dataCHUNK 
- * @param len 
- * @return uint32_t 
+ * @brief crc32 update method, on the crc register
+ * @note the register is the inverted crc32 : start with 0xffffffff and invert the final value.
+ * @see CRC32::update for updating a crc32 value
+ *
+ * @param crc the crc register
+ * @param dataCHUNK the datas to add to the crc
+ * @param len the datas length
+ * @return uint32_t the updated crc register
  */
 uint32_t CRC32::CRC32_update(uint32_t crc, uint8_t *dataCHUNK, int len)
 {
-    if (!crc_table_computed)
-        CRC32_table_compute();
-        
-    for (int i = 0; i < len; i++)
-        crc = crc_table[(crc ^ dataCHUNK[i]) & 0xff] ^ (crc >> 8);
+    return get_kernel().update(crc, dataCHUNK, static_cast<std::size_t>(len));
+}
+
+/**
+ * @brief crc32 incremental update method
+ * @details the crc32 of concatened buffers is computed by chaining updates, without concatenating them :
+ * update(update(0, a, lenA), b, lenB) is the crc32 of a followed by b.
+ *
+ * @param crc the crc32 of the previous datas, 0 for the first datas
+ * @param datas the datas to add to the crc
+ * @param len the datas length
+ * @return uint32_t the crc32 of the previous datas followed by the new datas
+ */
+uint32_t CRC32::update(uint32_t crc, const uint8_t *datas, std::size_t len) noexcept
+{
+    return ~get_kernel().update(~crc, datas, len);
+}
 
-    return crc;
-}
\ No newline at end of file
+/**
+ * @brief crc32 combination method
+ * @details computes the crc32 of two concatened buffers from their own crc32, in O(log(len2)),
+ * so that buffers parts can be checksummed in parallel then merged.
+ *
+ * @param crc1 the crc32 of the first buffer
+ * @param crc2 the crc32 of the second buffer
+ * @param len2 the length of the second buffer
+ * @return uint32_t the crc32 of the first buffer followed by the second buffer
+ */
+uint32_t CRC32::combine(uint32_t crc1, uint32_t crc2, std::size_t len2) noexcept
+{
+    return multmodp(x2nmodp(len2, 3), crc1) ^ crc2;
+}
+
+/**
+ * @brief get the crc32 implementation actually in use
+ *
+ * @return CRC32::Engine
+ */
+CRC32::Engine CRC32::get_engine() noexcept
+{
+    return get_kernel().engine;
+}
+
+/**
+ * @brief force a crc32 implementation, mainly for testing and benchmarking
+ * @warning if the running cpu does not support it, the best supported implementation is used instead.
+ *
+ * @param engine the wanted implementation
+ */
+void CRC32::set_engine(Engine engine) noexcept
+{
+    get_kernel() = select_kernel(engine);
+}
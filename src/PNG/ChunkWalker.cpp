@@ -0,0 +1,203 @@
+#include <cstring>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+#include "../../include/PNG/Utilities.h"
+#include "../../include/PNG/ChunkWalker.h"
+
+
+/**
+ * @brief Construct a new ChunkWalker::ChunkWalker object, mapping and walking the specified png file
+ *
+ * @param path the png file path to map
+ *
+ * @exception std::runtime_error if the file cannot be opened or mapped
+ * @exception std::runtime_error if the file is not a png file or if a chunk is truncated
+ */
+ChunkWalker::ChunkWalker(const std::string &path)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Enable to open the file \"" + path + "\"");
+
+    LARGE_INTEGER size;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping != nullptr)
+    {
+        m_mapped = static_cast<const uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        m_mappedLen = static_cast<std::size_t>(size.QuadPart);
+        CloseHandle(mapping); // the view keeps the mapping alive
+    }
+    CloseHandle(file);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        throw std::runtime_error("Enable to open the file \"" + path + "\"");
+
+    struct stat status;
+    if (fstat(fd, &status) == 0 && status.st_size > 0)
+    {
+        void *mapped = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED)
+        {
+            madvise(mapped, static_cast<std::size_t>(status.st_size), MADV_SEQUENTIAL);
+            m_mapped = static_cast<const uint8_t *>(mapped);
+            m_mappedLen = static_cast<std::size_t>(status.st_size);
+        }
+    }
+    close(fd); // the mapping keeps its own reference to the file
+#endif
+
+    if (m_mapped == nullptr)
+        throw std::runtime_error("Enable to map the file \"" + path + "\"");
+    m_owned = true;
+
+    try
+    {
+        walk();
+    }
+    catch (const std::exception &exception)
+    {
+        unmap();
+        throw std::runtime_error("\"" + path + "\" : " + exception.what());
+    }
+}
+
+/**
+ * @brief Construct a new ChunkWalker::ChunkWalker object, walking an in memory png
+ * @warning the datas are not copied, they must stay alive and unchanged while the walker and its chunks records are used.
+ *
+ * @param datas the png datas, from the signature
+ * @param len the png datas length
+ *
+ * @exception std::runtime_error if the datas are not a png or if a chunk is truncated
+ */
+ChunkWalker::ChunkWalker(const uint8_t *datas, std::size_t len)
+    : m_mapped(datas), m_mappedLen(len)
+{
+    if (m_mapped == nullptr)
+        m_mappedLen = 0;
+    walk();
+}
+
+/**
+ * @brief Destroy the ChunkWalker::ChunkWalker object, unmapping the file
+ *
+ */
+ChunkWalker::~ChunkWalker()
+{
+    unmap();
+}
+
+/**
+ * @brief walking the chunks list once, from the signature to the IEND chunk
+ * @details each chunk is located with the length field of the previous one, so that chunk types bytes
+ * which could appear inside compressed datas are never mistaken for chunk headers.
+ *
+ * @exception std::runtime_error if the png signature is invalid
+ * @exception std::runtime_error if a chunk goes beyond the end of the file
+ */
+void ChunkWalker::walk()
+{
+    static const uint8_t signature[8] = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A};
+    if (m_mappedLen < 8 || std::memcmp(m_mapped, signature, 8) != 0)
+        throw std::runtime_error("Invalid PNG signature");
+
+    std::size_t pos = 8;
+    while (pos < m_mappedLen)
+    {
+        if (m_mappedLen - pos < 12) // length, type and crc32 fields are always present
+            throw std::runtime_error("Truncated chunk at offset " + std::to_string(pos));
+
+        Chunk chunk;
+        chunk.length = Utilities::read_be32(m_mapped + pos);
+        if (chunk.length > 0x7FFFFFFFu || m_mappedLen - pos - 12 < chunk.length)
+            throw std::runtime_error("Truncated chunk at offset " + std::to_string(pos));
+
+        std::memcpy(chunk.type, m_mapped + pos + 4, 4);
+        chunk.data = m_mapped + pos + 8;
+        chunk.crc32 = Utilities::read_be32(chunk.data + chunk.length);
+        m_chunks.push_back(chunk);
+
+        pos += 12 + chunk.length;
+        if (chunk.is("IEND")) // nothing after IEND belongs to the png
+            break;
+    }
+}
+
+/**
+ * @brief unmapping the mapped file, if any (in memory datas belong to the caller)
+ *
+ */
+void ChunkWalker::unmap() noexcept
+{
+    if (m_mapped == nullptr || !m_owned)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(m_mapped);
+#else
+    munmap(const_cast<uint8_t *>(m_mapped), m_mappedLen);
+#endif
+    m_mapped = nullptr;
+    m_mappedLen = 0;
+}
+
+/**
+ * @brief get all the chunks records, in file order
+ *
+ * @return const std::vector<ChunkWalker::Chunk>&
+ */
+const std::vector<ChunkWalker::Chunk> &ChunkWalker::get_chunks() const noexcept
+{
+    return m_chunks;
+}
+
+/**
+ * @brief get the first chunk of a specified type
+ *
+ * @param chunkType the chunk type to search (ex : "IHDR")
+ * @return either nullptr if the chunk is not present or a pointer to the chunk record
+ */
+const ChunkWalker::Chunk *ChunkWalker::find(const char *chunkType) const noexcept
+{
+    for (const auto &chunk : m_chunks)
+        if (chunk.is(chunkType))
+            return &chunk;
+    return nullptr;
+}
+
+/**
+ * @brief get all the chunks of a specified type, in file order
+ *
+ * @param chunkType the chunk type to search (ex : "IDAT")
+ * @return a vector of pointers to the chunks records
+ */
+std::vector<const ChunkWalker::Chunk *> ChunkWalker::find_all(const char *chunkType) const
+{
+    std::vector<const Chunk *> found;
+    for (const auto &chunk : m_chunks)
+        if (chunk.is(chunkType))
+            found.push_back(&chunk);
+    return found;
+}
+
+/**
+ * @brief test if the chunk has a specified type
+ *
+ * @param chunkType the chunk type to test (4 letters)
+ * @return bool
+ */
+bool ChunkWalker::Chunk::is(const char *chunkType) const noexcept
+{
+    return std::memcmp(type, chunkType, 4) == 0;
+}
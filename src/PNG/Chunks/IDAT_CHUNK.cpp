@@ -2,6 +2,7 @@
 // #include "../../../include/zlib/zlib.h"
 #include <zlib.h>
 #include "../../../include/PNG/CRC32.h"
+#include "../../../include/PNG/Filters.h"
 #include "../../../include/PNG/Utilities.h"
 #include "../../../include/PNG/Chunks/IDAT_CHUNK.h"
 
@@ -12,21 +13,23 @@
  * @param s_width the png width (according to the pixelsBuffer)
  * @param s_height the png height (according to the pixelsBuffer)
  * @param colorChannel the png color channel number
+ * @param options the encoding options (zlib parameters and filter selection strategy)
+ *
+ * @exception std::invalid_argument case Invalid encoding options
+ * @exception std::runtime_error if the deflate stream cannot be initialised, or if the datas cannot be deflated
  */
-IDAT_CHUNK::IDAT_CHUNK(const uint8_t *pixelsBuffer, int s_width, int s_height, int colorChannel)
+IDAT_CHUNK::IDAT_CHUNK(const uint8_t *pixelsBuffer, int s_width, int s_height, int colorChannel, const EncodeOptions &options)
 {
+    m_data = deflate_datas(pixelsBuffer, s_width, s_height, colorChannel, options, m_length); // getting the deflated data output
+
     this->m_type = new uint8_t[4]; // setting the IDAT type (IDAT in Hexadecimal)
     this->m_type[0] = 0x49;        // I
     this->m_type[1] = 0x44;        // D
     this->m_type[2] = 0x41;        // A
     this->m_type[3] = 0x54;        // T
 
-    m_data = deflate_datas(pixelsBuffer, s_width, s_height, colorChannel, m_length); // getting the deflated data output
-
-    // the crc32 calculation algorithm needs the concatened array of the chunk type and the chunk datas
-    uint8_t *dataCRC = Utilities::getConcatenedArray(this->m_type, m_data, 4, m_length);
-    m_crc32 = CRC32::getCRC32(dataCRC, 4 + m_length);
-    delete[] dataCRC;
+    // the crc32 covers the chunk type followed by the chunk datas
+    m_crc32 = CRC32::update(CRC32::update(0, this->m_type, 4), m_data, m_length);
 }
 
 /**
@@ -40,288 +43,418 @@ IDAT_CHUNK::~IDAT_CHUNK()
 }
 
 /**
- * @brief save the actual IDAT_CHUNK datas(type, length, datas, crc32) to a specific output file stream
+ * @brief save the actual IDAT_CHUNK datas(type, length, datas, crc32) to an output sink
  *
- * @param outputStream the output file stream reference
+ * @param sink the output sink reference
  */
-void IDAT_CHUNK::save(std::ofstream &outputStream)
+void IDAT_CHUNK::save(OutputSink &sink)
 {
-    // we start by converting the (> 1 byte) values into arrays of bytes
-    uint8_t *lengthArrayPtr = Utilities::int_to_uint8(this->m_length);
-    uint8_t *crc32ArrayPtr = Utilities::int_to_uint8(this->m_crc32);
-
-    // then we write chunk datas in the file stream
-    Utilities::stream_write(lengthArrayPtr, 4, outputStream);
-    Utilities::stream_write(this->m_type, 4, outputStream);
-    Utilities::stream_write(this->m_data, this->m_length, outputStream);
-    Utilities::stream_write(crc32ArrayPtr, 4, outputStream);
-
-    delete[] lengthArrayPtr;
-    delete[] crc32ArrayPtr; // freeing the bytes arrays
+    sink.write_chunk(this->m_type, this->m_data, this->m_length, this->m_crc32);
 }
 
 /**
  * @brief method for generate scanlines from a specified pixels buffer.
- * @details for image size optimisation, this method is based on a simple way : 
- * for each pixel line, we test all the filtering mode and get the one in which the filtered line has the highest values repetitons(lowest set cardinal).
- * @note Now supports multi-threading mode!!
- * @warning case the image height is too small for multi threading supports, the process will be executed in a single thread.
+ * @details each pixel line is filtered with the filter mode chosen by the filtering strategy, directly in the output scanlines.
+ * The lines are split in contiguous bands, one per thread : a line only depends on the unfiltered previous line, so bands are independent.
+ * @see Filters::Strategy
  * @param pixels input pixels buffer
  * @param s_width pixels buffer width
  * @param s_height pixels buffer height
- * @param colorChannel pixels buffer color channel number
+ * @param colorChannel pixels buffer number of bytes per pixel
+ * @param filtering the filter selection strategy
+ * @param options the encoding options, the zlib parameters are used for trial deflates
  * @return uint8_t* output filtered scanline
+ *
+ * @exception std::invalid_argument case Invalid fixed filter mode or bytes per pixel
+ * @exception std::runtime_error if a trial deflate stream cannot be initialised, or if a trial deflate failed
+ * @exception std::bad_alloc if a trial buffer allocation failed
  */
-uint8_t *IDAT_CHUNK::generate_scanlines(const uint8_t *pixels, int s_width, int s_height, int colorChannel)
-{        
-    // lambda for generating scanlines...
-    auto generate = [this](const uint8_t *pixels, int s_width, int s_height, int colorChannel, bool is_prev_line) -> uint8_t*
-    {
-        uint8_t *scanlines = new uint8_t[s_height * (1 + s_width * colorChannel)]; // output
+uint8_t *IDAT_CHUNK::generate_scanlines(const uint8_t *pixels, int s_width, int s_height, int colorChannel, const Filters::Strategy &filtering, const EncodeOptions &options)
+{
+    if (colorChannel < 1 || colorChannel > 8)
+        throw std::invalid_argument("Invalid bytes per pixel number : " + std::to_string(colorChannel));
+    if (filtering.selection == Filters::Selection::FIXED && filtering.fixedFilter > 0x4)
+        throw std::invalid_argument("Invalid filter mode is specified : 0x" + std::to_string(filtering.fixedFilter));
 
-        uint8_t *tmp_filtered_line{nullptr};          // temp filtered lines buffer
-        std::vector<uint8_t> filters_modes(s_height); // lowest filter modes container
-        for (int i = 1; i <= s_height; ++i)           // testing each filter mode and stores the one with lowest Cardinal.
+    const int lineLength = s_width * colorChannel;
+    uint8_t *scanlines_out = new uint8_t[static_cast<std::size_t>(s_height) * (1 + lineLength)]; // output
+    const std::vector<uint8_t> zeroLine(lineLength, 0); // previous line of the first line
+
+    // a thread for each band of at least 64 lines, the calling thread handles the first band
+    int thread_number = std::max(1, std::min(get_thread_number(options), s_height / 64));
+    std::vector<std::exception_ptr> errors(thread_number); // the exceptions of the bands, an exception must not leave its thread
+
+    // lambda filtering the lines [first, last) of a band
+    auto generate = [&](int band, int first, int last)
+    {
+        z_stream trialStream; // only used by the brute force strategy
+        trialStream.zalloc = Z_NULL;
+        trialStream.zfree = Z_NULL;
+        trialStream.opaque = Z_NULL;
+        bool initialised = false;
+        try
         {
-            std::vector<int> filterMode_cardinal;
-            for (uint8_t tmp_filter_mode = 0; tmp_filter_mode <= 4; ++tmp_filter_mode)
+            std::vector<uint8_t> trialDatas;
+            if (filtering.selection == Filters::Selection::BRUTE_FORCE)
             {
-                tmp_filtered_line = filter_line(pixels + (i - 1) * (s_width * colorChannel), // filtering
-                                                s_width * colorChannel,
-                                                tmp_filter_mode,
-                                                (i - 1) == 0 && !is_prev_line ? false : true,
-                                                (i - 1) == 0 && !is_prev_line ? nullptr : pixels + (i - 2) * (s_width * colorChannel),
-                                                colorChannel);
-
-                filterMode_cardinal.push_back(Utilities::get_cardinal(tmp_filtered_line, s_width * colorChannel)); // conputing Cardinal
-                delete[] tmp_filtered_line;
+                if (deflateInit2(&trialStream, std::max(1, options.level), Z_DEFLATED, options.windowBits, options.memLevel, options.strategy) != Z_OK)
+                    throw std::runtime_error("IDAT_CHUNK - Enable to initialise trial deflate stream");
+                initialised = true;
+                trialDatas.resize(deflateBound(&trialStream, lineLength));
             }
 
-            // storing filter mode with lowest Cardinal
-            auto min = std::min_element(filterMode_cardinal.begin(), filterMode_cardinal.end());
-            filters_modes[i - 1] = min - filterMode_cardinal.begin();
-            filterMode_cardinal.clear();
-        }
-
-        uint8_t **filtered_line = new uint8_t *[s_height]; // filtering all pixels lines with the previously stored filters modes
-        for (int i = 1; i <= s_height; i++)
-            memcpy(
-                scanlines + 1 + (i - 1) * (1 + s_width * colorChannel),
-                (filtered_line[i - 1] = filter_line(pixels + (i - 1) * (s_width * colorChannel),
-                                                    s_width * colorChannel, filters_modes[i - 1],
-                                                    (i - 1) == 0 && !is_prev_line ? false : true,
-                                                    (i - 1) == 0 && !is_prev_line ? nullptr : pixels + (i - 2) * (s_width * colorChannel),
-                                                    colorChannel)),
-                s_width * colorChannel);
-
-        // writing filter mode bit in each line.
-        for (int i = 1; i <= s_height; ++i)
-            scanlines[(i - 1) * (1 + s_width * colorChannel)] = filters_modes[i - 1];
-
-        for (int i = 0; i < s_height; i++)
-            delete[] filtered_line[i];
-        filters_modes.clear();
-
-        return scanlines;
-    };
-
-    uint8_t *scanlines_out = new uint8_t[s_height * (1 + s_width * colorChannel)]; // output
-    int thread_number = std::thread::hardware_concurrency(); // getting logical UC avaible on computer
-
-    // cause this method separates the input buffer in equals parts(in terms of lines : s_height) for computing,
-    // we'll round(down) the threads number to correspond as dividing equally the buffer
-    const bool is_dividor{s_height % thread_number == 0};
-    int eff_threads{thread_number};
-    if (!is_dividor)
-    {
-        for (std::size_t i = thread_number; i >= 1; --i)
-            if ((s_height % i) == 0)
+            uint8_t filterMode = filtering.fixedFilter;
+            for (int i = first; i < last; ++i)
             {
-                eff_threads = i;
-                break;
+                const uint8_t *line = pixels + static_cast<std::size_t>(i) * lineLength;
+                const uint8_t *prev_line = (i == 0) ? zeroLine.data() : line - lineLength;
+                uint8_t *scanline = scanlines_out + static_cast<std::size_t>(i) * (1 + lineLength);
+
+                switch (filtering.selection)
+                {
+                case Filters::Selection::FIXED:
+                    break;
+
+                case Filters::Selection::ADAPTIVE_FAST: // the lines between two scored lines reuse the last choice
+                    if ((i - first) % std::max(1, filtering.rescoreInterval) == 0)
+                        filterMode = Filters::select_filter(line, prev_line, lineLength, colorChannel);
+                    break;
+
+                case Filters::Selection::BRUTE_FORCE:
+                    filterMode = trial_filter(trialStream, trialDatas, scanline + 1, line, prev_line, lineLength, colorChannel);
+                    break;
+
+                default:
+                    filterMode = Filters::select_filter(line, prev_line, lineLength, colorChannel);
+                    break;
+                }
+
+                scanline[0] = filterMode; // writing filter mode byte
+                Filters::filter_line(scanline + 1, line, prev_line, lineLength, filterMode, colorChannel);
             }
-    }
+        }
+        catch (...)
+        {
+            errors[band] = std::current_exception();
+        }
 
-    // case the image height is too small for multi threading supports, 
-    // the process will be executed in a single thread.
-    if(s_height < eff_threads)
-        return generate(pixels, s_width, s_height, colorChannel, false);
+        if (initialised)
+            deflateEnd(&trialStream);
+    };
 
-    // threads related declarations. _s suufix means plural
     std::vector<std::thread> task_s;
-    std::vector<std::future<uint8_t *>> future_s;
-    std::vector<std::promise<uint8_t *>> promise_s(eff_threads);
-
-    std::vector<uint8_t *> result_s; // vector for storing computed results
-
-    // lambda for thread creation
-    auto thread_create_s = [&generate](const uint8_t *pixels, int s_width, int s_height, int colorChannel, bool is_prev_line, std::promise<uint8_t *> &p)
-    {
-        p.set_value(generate(pixels, s_width, s_height, colorChannel, is_prev_line));
-    };
+    for (int i = 1; i < thread_number; ++i)
+        task_s.emplace_back(generate, i, s_height * i / thread_number, s_height * (i + 1) / thread_number);
+    generate(0, 0, s_height / thread_number);
 
-    int thread_height = s_height / eff_threads;
-    int thread_buff_len{thread_height * s_width * colorChannel};
+    for (auto &task : task_s) // waiting for all threads to finish
+        task.join();
 
-    // creating and storing threads in out task list
-    for (std::size_t i = 0; i < eff_threads; ++i) 
-        task_s.emplace_back(std::thread(thread_create_s, pixels + (i * thread_buff_len), s_width, thread_height, colorChannel, (i == 0) ? false : true, std::ref(promise_s[i])));
-    
-    int i{0};
-    for (i = 0; i < eff_threads; ++i) // futures results for each thread
-        future_s.emplace_back(promise_s[i].get_future());
+    for (const auto &error : errors)
+        if (error)
+        {
+            delete[] scanlines_out;
+            std::rethrow_exception(error);
+        }
 
-    for (i = 0; i < eff_threads; ++i) // waiting for all threads to finish
-        task_s[i].join();
+    return scanlines_out;
+}
 
-    for (i = 0; i < eff_threads; ++i) // storing results
-        result_s.push_back(future_s[i].get());
+/**
+ * @brief getting the filter mode of a line by trial deflate, the smallest deflated line wins
+ * @details each filtered line is deflated alone, the stream is reset between each trial.
+ *
+ * @param trialStream an initialised deflate stream
+ * @param trialDatas the deflated output buffer, at least deflateBound(lineLength) bytes
+ * @param line_out a line of lineLength bytes, used for the filtered candidates
+ * @param line the line to filter
+ * @param prev_line the predecessor line (not filtered)
+ * @param lineLength the line length
+ * @param colorChannel the number of bytes per pixel
+ * @return uint8_t the best filter mode
+ *
+ * @exception std::runtime_error if a trial deflate failed
+ */
+uint8_t IDAT_CHUNK::trial_filter(z_stream &trialStream, std::vector<uint8_t> &trialDatas, uint8_t *line_out, const uint8_t *line, const uint8_t *prev_line, int lineLength, int colorChannel)
+{
+    uint8_t bestMode(0);
+    uLong bestLen(~0ul);
+    for (uint8_t filterMode = 0; filterMode <= 4; ++filterMode)
+    {
+        Filters::filter_line(line_out, line, prev_line, lineLength, filterMode, colorChannel);
 
-    for (i = 0; i < eff_threads; ++i) // copying results to output buffer
-        std::memcpy(scanlines_out + (i * (thread_buff_len + thread_height)), result_s[i], thread_buff_len + thread_height); 
+        deflateReset(&trialStream);
+        trialStream.next_in = line_out;
+        trialStream.avail_in = lineLength;
+        trialStream.next_out = trialDatas.data();
+        trialStream.avail_out = static_cast<uInt>(trialDatas.size());
+        if (deflate(&trialStream, Z_FINISH) != Z_STREAM_END)
+            throw std::runtime_error("IDAT_CHUNK - Enable to deflate a trial line");
 
-    for (i = 0; i < eff_threads; ++i) // free results for each thread.
-        delete[] result_s[i];
-    
-    return scanlines_out;
+        if (trialStream.total_out < bestLen)
+        {
+            bestLen = trialStream.total_out;
+            bestMode = filterMode;
+        }
+    }
+    return bestMode;
 }
 
 /**
  * @brief deflate() an input pixels buffer method
+ * @details the zlib stream is configured with the encoding options. In store mode, scanlines are not filtered (filter mode 0)
+ * and stored without compression. Scanlines of large images are deflated in parallel bands.
+ * @see IDAT_CHUNK::deflate_bands
  *
  * @param pixelBuffer the input pixels buffer
  * @param s_width the number of pixels in the pixels buffer (width)
  * @param s_height the number of pixels in the pixels buffer (height)
  * @param colorChannel the number of color channel in the pixels buffer
+ * @param options the encoding options
  * @param deflatedLen a reference for getting the output defalted length
  * @return a pointer to the deflated datas buffer
+ *
+ * @exception std::invalid_argument case Invalid encoding options
+ * @exception std::runtime_error if the deflate stream cannot be initialised, or if the datas cannot be deflated
  */
-uint8_t *IDAT_CHUNK::deflate_datas(const uint8_t *pixelBuffer, int s_width, int s_height, int colorChannel, int &deflatedLen)
+uint8_t *IDAT_CHUNK::deflate_datas(const uint8_t *pixelBuffer, int s_width, int s_height, int colorChannel, const EncodeOptions &options, int &deflatedLen)
 {
-    unsigned long inLen = s_height * (1 + s_width * colorChannel), tmpLen = 0;            // input len of scanlines datas
-    uint8_t *scanlines = generate_scanlines(pixelBuffer, s_width, s_height, colorChannel); // generating scanlines from the pixels
+    if (options.windowBits < 9 || options.windowBits > 15) // a png zlib stream can't use a window larger than 32K
+        throw std::invalid_argument("Invalid deflate window bits : " + std::to_string(options.windowBits));
 
-    uint8_t *deflatedDatas = nullptr; // setting up the deflated datas output
-    int result = 0;
+    Filters::Strategy filtering = options.filtering;
+    int level = options.level;
+    if (options.store) // store mode, no filtering and no compression
+    {
+        filtering.selection = Filters::Selection::FIXED;
+        filtering.fixedFilter = 0x0;
+        level = Z_NO_COMPRESSION;
+    }
 
-    // initialising zlib
+    // initialising zlib, before generating scanlines so that invalid parameters fail fast
     z_stream defstream;
     defstream.zalloc = Z_NULL;
     defstream.zfree = Z_NULL;
     defstream.opaque = Z_NULL;
+
+    int result = deflateInit2(&defstream, level, Z_DEFLATED, options.windowBits, options.memLevel, options.strategy);
+    if (result == Z_STREAM_ERROR)
+        throw std::invalid_argument("Invalid deflate parameters : level " + std::to_string(level) + ", strategy " + std::to_string(options.strategy) + ", memLevel " + std::to_string(options.memLevel));
+    if (result != Z_OK)
+        throw std::runtime_error("IDAT_CHUNK - Enable to initialise deflate stream");
+
+    unsigned long inLen = static_cast<unsigned long>(s_height) * (1 + s_width * colorChannel); // input len of scanlines datas
+    uint8_t *scanlines = nullptr;
+    try
+    {
+        scanlines = generate_scanlines(pixelBuffer, s_width, s_height, colorChannel, filtering, options); // generating scanlines from the pixels
+    }
+    catch (...)
+    {
+        deflateEnd(&defstream);
+        throw;
+    }
+
+    // large images are split in bands deflated in parallel, see IDAT_CHUNK::deflate_bands
+    const int scanlineLength = 1 + s_width * colorChannel;
+    int bandNumber = std::min<long long>(get_thread_number(options), inLen / minBandLength);
+    bandNumber = std::min(bandNumber, s_height);
+    if (level != Z_NO_COMPRESSION && bandNumber > 1)
+    {
+        deflateEnd(&defstream);
+        uint8_t *deflatedDatas = nullptr;
+        try
+        {
+            deflatedDatas = deflate_bands(scanlines, s_height, scanlineLength, level, options, bandNumber, deflatedLen);
+        }
+        catch (...)
+        {
+            delete[] scanlines;
+            throw;
+        }
+        delete[] scanlines;
+        return deflatedDatas;
+    }
+
+    // calculate the actual length and update zlib structure
+    unsigned long estimateLen = deflateBound(&defstream, inLen);
+    uint8_t *deflatedDatas = new uint8_t[estimateLen];
+
     defstream.avail_in = inLen;
     defstream.next_in = (Bytef *)scanlines;
-    defstream.avail_out = 0;
+    defstream.avail_out = (uInt)estimateLen;
     defstream.next_out = (Bytef *)deflatedDatas;
 
-    if ((result = deflateInit(&defstream, Z_BEST_COMPRESSION)) == Z_OK)
+    // do the compression
+    result = deflate(&defstream, Z_FINISH);
+    if (result != Z_STREAM_END)
     {
-        // calculate the actual length and update zlib structure
-        unsigned long estimateLen = deflateBound(&defstream, inLen);
-        deflatedDatas = new uint8_t[estimateLen];
-        if (deflatedDatas != nullptr)
-        {
-            // updation zlib configuration
-            defstream.avail_out = (uInt)estimateLen;
-            defstream.next_out = (Bytef *)deflatedDatas;
-
-            // do the compression
-            deflate(&defstream, Z_FINISH);
-            tmpLen = (uint8_t *)defstream.next_out - deflatedDatas;
-        }
+        deflateEnd(&defstream);
+        delete[] scanlines;
+        delete[] deflatedDatas;
+        throw std::runtime_error("IDAT_CHUNK - Enable to deflate datas : zlib error " + std::to_string(result));
     }
+    deflatedLen = (uint8_t *)defstream.next_out - deflatedDatas; // copying the deflated data length to the IDAT->length attribut
+
     deflateEnd(&defstream); // end of deflating algorithm
-    deflatedLen = tmpLen;   // copying the deflated data length to the IDAT->length attribut
     delete[] scanlines;
 
     return deflatedDatas;
 }
 
 /**
- * @brief filtering line method
- * @details png format has many filtering options for improving the compression(deflate)
- * then after decompression(inflate), datas needs to be unfiltered, according to the specified filter method
- * @note filtering and unfiltering methods are applied one each line.
+ * @brief deflate() the scanlines in parallel, as independent bands of lines stitched in a single zlib stream
+ * @details each band is a raw deflate stream primed with the last window of scanlines of the previous band (deflateSetDictionary),
+ * so that matches can still reach back across the band boundary. Bands end with Z_SYNC_FLUSH (byte aligned, not final),
+ * except the last one which ends the stream. The zlib header is written once, and the Adler-32 checksums
+ * of the bands are merged with adler32_combine().
  *
- * @param line_in the input line to unfilter
- * @param lineLength the input line length
- * @param filterMode the filter mode of the actual line ( 0 = none, 1 = Sub, 2 = Up, 3 = Average, 4 = Paeth)
- * @param is_prev_line if the actual line have a predecessor line
- * @param unfiltered_prev_line the predecessor line (no filtered)
- * @param colorChannel the number of color channel of the input line
- * @return uint8_t* filtered line
+ * @param scanlines the filtered scanlines
+ * @param s_height the number of scanlines
+ * @param scanlineLength the length of a scanline, filter mode byte included
+ * @param level the zlib compression level
+ * @param options the encoding options, for the zlib parameters
+ * @param bandNumber the number of bands, each one deflated by its own thread
+ * @param deflatedLen a reference for getting the output defalted length
+ * @return a pointer to the deflated datas buffer
  *
- * @exception std::bad_alloc case filtered line memory allocation failed
- * @exception std::invalid_argument case Invalid filter mode
+ * @exception std::runtime_error if the deflate stream of a band cannot be initialised, or if a band cannot be deflated
+ * @exception std::bad_alloc if a band buffer allocation failed
  */
-uint8_t *IDAT_CHUNK::filter_line(const uint8_t *line_in, int lineLength, uint8_t filterMode, bool is_prev_line, const uint8_t *unfiltered_prev_line, uint8_t colorChannel)
+uint8_t *IDAT_CHUNK::deflate_bands(const uint8_t *scanlines, int s_height, int scanlineLength, int level, const EncodeOptions &options, int bandNumber, int &deflatedLen)
 {
-    int i(0);
-    uint8_t *line_out = new uint8_t[lineLength]; // unfiltered output buffer
-    if (!line_out)
-        throw std::bad_alloc();
-
-    switch (filterMode)
+    struct Band
     {
-    case 0x0: // filter mode 0(none), output buffer is the same as the in buffer
-        memcpy(line_out, line_in, lineLength);
-        break;
-
-    case 0x1: // filter mode 1(Sub),
-        memcpy(line_out, line_in, colorChannel);
+        std::vector<uint8_t> datas; /**< the raw deflated datas of the band */
+        unsigned long length = 0;   /**< the length of the scanlines of the band */
+        uLong adler = 0;            /**< the adler32 of the scanlines of the band */
+        int status = Z_OK;          /**< the result of the failed zlib call, Z_OK if the band is deflated */
+        std::exception_ptr error;   /**< the exception thrown while deflating the band, rethrown by the calling thread */
+    };
+    std::vector<Band> bands(bandNumber);
+    const std::size_t windowSize = std::size_t(1) << options.windowBits;
 
-        for (i = colorChannel; i < lineLength; i++)
-            line_out[i] = (uint8_t)(line_in[i] - line_in[i - colorChannel]);
-        break;
+    // lambda deflating a single band, the failures are kept in the band : an exception must not leave its thread
+    auto compress = [&](int i)
+    {
+        Band &band = bands[i];
+        z_stream stream;
+        stream.zalloc = Z_NULL;
+        stream.zfree = Z_NULL;
+        stream.opaque = Z_NULL;
+        bool initialised = false;
+        try
+        {
+            std::size_t begin = static_cast<std::size_t>(s_height * static_cast<long long>(i) / bandNumber) * scanlineLength;
+            std::size_t end = static_cast<std::size_t>(s_height * static_cast<long long>(i + 1) / bandNumber) * scanlineLength;
+            band.length = end - begin;
+            band.adler = adler32(adler32(0L, Z_NULL, 0), scanlines + begin, band.length);
 
-    case 0x2: // filter mode 2(Up)
-        if (!is_prev_line)
-            memcpy(line_out, line_in, lineLength);
+            band.status = deflateInit2(&stream, level, Z_DEFLATED, -options.windowBits, options.memLevel, options.strategy); // raw deflate, no header
+            if (band.status != Z_OK)
+                return;
+            initialised = true;
 
-        else
-            for (i = 0; i < lineLength; i++)
-                line_out[i] = (uint8_t)(line_in[i] - unfiltered_prev_line[i]);
-        break;
+            if (begin > 0) // priming the window with the end of the previous band
+            {
+                std::size_t dictionaryLen = std::min(windowSize, begin);
+                band.status = deflateSetDictionary(&stream, scanlines + begin - dictionaryLen, dictionaryLen);
+                if (band.status != Z_OK)
+                {
+                    deflateEnd(&stream);
+                    return;
+                }
+            }
 
-    case 0x3: // filter mode 3(Average)
-        if (!is_prev_line)
-        {
-            memcpy(line_out, line_in, colorChannel);
+            const int flush = (i == bandNumber - 1) ? Z_FINISH : Z_SYNC_FLUSH;
+            band.datas.resize(deflateBound(&stream, band.length) + 16); // a sync flush adds an empty stored block
+            stream.next_in = const_cast<Bytef *>(scanlines + begin);
+            stream.avail_in = band.length;
 
-            for (i = colorChannel; i < lineLength; i++)
-                line_out[i] = (uint8_t)(line_in[i] - floor((line_in[i - colorChannel]) / 2));
+            std::size_t produced = 0;
+            int result = Z_OK;
+            for (;;)
+            {
+                stream.next_out = band.datas.data() + produced;
+                stream.avail_out = band.datas.size() - produced;
+                result = deflate(&stream, flush);
+                if (result != Z_OK && result != Z_BUF_ERROR && result != Z_STREAM_END)
+                    break;
+                produced = band.datas.size() - stream.avail_out;
+                if (stream.avail_out != 0) // the flush (or the end of the stream) is complete
+                    break;
+                band.datas.resize(band.datas.size() * 2);
+            }
+            if ((flush == Z_FINISH) ? (result != Z_STREAM_END) : (result != Z_OK && result != Z_BUF_ERROR))
+                band.status = (result == Z_OK) ? Z_BUF_ERROR : result;
+            band.datas.resize(produced);
+            deflateEnd(&stream);
         }
-        else
+        catch (...)
         {
-            for (i = 0; i < colorChannel; i++)
-                line_out[i] = (uint8_t)(line_in[i] - (floor((unfiltered_prev_line[i]) / 2)));
-
-            for (i = colorChannel; i < lineLength; i++)
-                line_out[i] = (uint8_t)(line_in[i] - floor((line_in[i - colorChannel] + unfiltered_prev_line[i]) / 2));
+            if (initialised)
+                deflateEnd(&stream);
+            band.error = std::current_exception();
         }
-        break;
+    };
 
-    case 0x4: // filter mode 4(Paeth)
-        if (!is_prev_line)
-        {
-            memcpy(line_out, line_in, colorChannel);
+    std::vector<std::thread> task_s;
+    for (int i = 1; i < bandNumber; ++i)
+        task_s.emplace_back(compress, i);
+    compress(0);
 
-            for (i = colorChannel; i < lineLength; i++)
-                line_out[i] = (uint8_t)(line_in[i] - Utilities::paeth_predictor(line_in[i - colorChannel], 0, 0));
-        }
-        else
-        {
-            for (i = 0; i < colorChannel; i++)
-                line_out[i] = (uint8_t)(line_in[i] - unfiltered_prev_line[i]);
+    for (auto &task : task_s) // waiting for all threads to finish
+        task.join();
 
-            for (i = colorChannel; i < lineLength; i++)
-                line_out[i] = (uint8_t)(line_in[i] - Utilities::paeth_predictor(line_in[i - colorChannel], unfiltered_prev_line[i], unfiltered_prev_line[i - colorChannel]));
-        }
-        break;
+    for (int i = 0; i < bandNumber; ++i)
+    {
+        if (bands[i].error)
+            std::rethrow_exception(bands[i].error);
+        if (bands[i].status != Z_OK)
+            throw std::runtime_error("IDAT_CHUNK - Enable to deflate datas band " + std::to_string(i) + " : zlib error " + std::to_string(bands[i].status));
+    }
 
-    default:
-        throw std::invalid_argument("Invalid filter mode is specified : 0x" + std::to_string(filterMode));
-        break;
+    // zlib header : deflate method with the window size, the level hint and the check bits
+    uint8_t cmf = static_cast<uint8_t>(((options.windowBits - 8) << 4) | Z_DEFLATED);
+    uint8_t flg = static_cast<uint8_t>(((level == Z_DEFAULT_COMPRESSION || level == 6) ? 2 : (level < 2) ? 0 : (level < 6) ? 1 : 3) << 6);
+    flg += 31 - ((cmf << 8) | flg) % 31;
+
+    std::size_t totalLen = 2 + 4;
+    uLong adler = bands[0].adler;
+    for (int i = 0; i < bandNumber; ++i)
+    {
+        totalLen += bands[i].datas.size();
+        if (i > 0)
+            adler = adler32_combine(adler, bands[i].adler, bands[i].length);
     }
-    return line_out;
-}
\ No newline at end of file
+
+    uint8_t *deflatedDatas = new uint8_t[totalLen];
+    uint8_t *out = deflatedDatas;
+    *out++ = cmf;
+    *out++ = flg;
+    for (const auto &band : bands)
+    {
+        std::memcpy(out, band.datas.data(), band.datas.size());
+        out += band.datas.size();
+    }
+    *out++ = static_cast<uint8_t>(adler >> 24); // adler32 trailer, big endian
+    *out++ = static_cast<uint8_t>(adler >> 16);
+    *out++ = static_cast<uint8_t>(adler >> 8);
+    *out++ = static_cast<uint8_t>(adler);
+
+    deflatedLen = static_cast<int>(totalLen);
+    return deflatedDatas;
+}
+
+/**
+ * @brief get the number of threads used for encoding
+ *
+ * @param options the encoding options
+ * @return int EncodeOptions::threads, or the number of hardware threads if it's 0
+ */
+int IDAT_CHUNK::get_thread_number(const EncodeOptions &options) noexcept
+{
+    if (options.threads > 0)
+        return options.threads;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
@@ -33,20 +33,11 @@ IEND_CHUNK::~IEND_CHUNK()
 }
 
 /**
- * @brief save the actual IEND_CHUNK datas(type, length, crc32) to an output file stream
+ * @brief save the actual IEND_CHUNK datas(type, length, crc32) to an output sink
  * 
- * @param outputStream the output file stream reference
+ * @param sink the output sink reference
  */
-void IEND_CHUNK::save(std::ofstream &outputStream)
+void IEND_CHUNK::save(OutputSink &sink)
 {
-    //we start by converting the (> 1 byte) values into arrays of bytes
-    uint8_t *lengthArrayPtr = Utilities::int_to_uint8(m_length);
-    uint8_t *crcArrayPtr = Utilities::int_to_uint8(m_crc32);
-
-    //then we write chunks datas in the file stream
-    Utilities::stream_write(lengthArrayPtr, 4, outputStream);
-    Utilities::stream_write(this->m_type, 4, outputStream);
-    Utilities::stream_write(crcArrayPtr, 4, outputStream);
-
-    delete[] lengthArrayPtr;    delete[] crcArrayPtr; //freeing the allocated memory
+    sink.write_chunk(this->m_type, nullptr, m_length, m_crc32);
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <cstdio>
+#include <cstring>
 #include <exception>
 
 #include "../../../include/PNG/CRC32.h"
@@ -35,19 +36,10 @@ IHDR_CHUNK::IHDR_CHUNK(int width, int height, int bitDepth, int colorMode)
     m_data[3] = 0x0;                //filter method (0), the only managed is 0(none).
     m_data[4] = 0x0;                //interlacing method (0)
 
-    uint8_t *widthArrayPtr = Utilities::int_to_uint8(m_width);
-    uint8_t *heightArrayPtr = Utilities::int_to_uint8(m_height);
-
-    uint8_t *cat_r1 = Utilities::getConcatenedArray(m_type, widthArrayPtr, 4, 4);
-    uint8_t *cat_r2 = Utilities::getConcatenedArray(heightArrayPtr, m_data, 4, 5);
-
-    //the crc32 calculation algorithm needs the concatened array of the chunk type and the chunk datas
-    uint8_t *dataCRC = Utilities::getConcatenedArray(cat_r1, cat_r2, 4 + 4, 5 + 4);
-
-    m_crc32 = CRC32::getCRC32(dataCRC, 9 + 2*4); //calculate  crc32 
-
-    delete[] widthArrayPtr;   delete[] heightArrayPtr;  delete[] dataCRC; 
-    delete[] cat_r1; delete[] cat_r2;
+    //the crc32 covers the chunk type followed by the chunk datas
+    uint8_t datas[13];
+    get_datas(datas);
+    m_crc32 = CRC32::update(CRC32::update(0, m_type, 4), datas, 13); //calculate  crc32 
 }
 
 /**
@@ -61,31 +53,50 @@ IHDR_CHUNK::~IHDR_CHUNK()
 }
 
 /**
- * @brief save the actual IEND_CHUNK datas(type, length, datas, crc32) to an output file stream
+ * @brief save the actual IHDR_CHUNK datas(type, length, datas, crc32) to an output sink
  * @warning cause computers architectures have different endianess, directly writing a not 8-bits size value on disk will not 
  * guarantee BIG-ENDIAN, which is  Endianess need by the PNG file format. 
- * For this reason, instead of write theses values, we'll write them with our own method, which is platform endianess-independent
- * @see Utilities::stream_write()
+ * For this reason, the width and height are written byte by byte, which is platform endianess-independent
+ * @see Utilities::write_be32()
  * 
- * @param outputStream the output file stream reference
+ * @param sink the output sink reference
  */
-void IHDR_CHUNK::save(std::ofstream &outputStream)
+void IHDR_CHUNK::save(OutputSink &sink)
 { 
-    uint8_t *lengthArrayPtr = Utilities::int_to_uint8(m_length);
-    uint8_t *widthArrayPtr = Utilities::int_to_uint8(m_width);
-    uint8_t *heightArrayPtr = Utilities::int_to_uint8(m_height);
-    uint8_t *crc32ArrayPtr = Utilities::int_to_uint8(m_crc32);
+    uint8_t datas[13];
+    get_datas(datas);
+    sink.write_chunk(m_type, datas, m_length, m_crc32);
+}
 
-    // writing values
-    Utilities::stream_write(lengthArrayPtr, 4, outputStream);
-    Utilities::stream_write(m_type, 4, outputStream);
-    Utilities::stream_write(widthArrayPtr, 4, outputStream);
-    Utilities::stream_write(heightArrayPtr, 4, outputStream);
-    Utilities::stream_write(m_data, 5, outputStream);
-    Utilities::stream_write(crc32ArrayPtr, 4, outputStream);
+/**
+ * @brief get the chunk datas, as written in the png file
+ * 
+ * @param datas the output, 13 bytes : width, height (big endian), bit depth, color mode, compression, filter and interlacing methods
+ */
+void IHDR_CHUNK::get_datas(uint8_t *datas) const noexcept
+{
+    Utilities::write_be32(datas, static_cast<uint32_t>(m_width));
+    Utilities::write_be32(datas + 4, static_cast<uint32_t>(m_height));
+    std::memcpy(datas + 8, m_data, 5);
+}
 
-    delete[] lengthArrayPtr;    delete[] crc32ArrayPtr;     //freeing the bytes arrays
-    delete[] widthArrayPtr;     delete[] heightArrayPtr;
+/**
+ * @brief read the fields of chunk datas, as written in a png file (same layout as IHDR_CHUNK::get_datas)
+ * 
+ * @param datas the chunk datas, 13 bytes
+ * @param width the png width
+ * @param height the png height
+ * @param bitDepth the png bit depth
+ * @param colorMode the png color mode
+ * @param interlacing the png interlacing method
+ */
+void IHDR_CHUNK::read_datas(const uint8_t *datas, int &width, int &height, uint8_t &bitDepth, uint8_t &colorMode, uint8_t &interlacing) noexcept
+{
+    width = Utilities::read_be32(datas);
+    height = Utilities::read_be32(datas + 4);
+    bitDepth = datas[8];
+    colorMode = datas[9];
+    interlacing = datas[12];
 }
 
 /**
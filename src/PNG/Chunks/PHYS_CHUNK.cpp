@@ -34,18 +34,10 @@ PHYS_CHUNK::PHYS_CHUNK(unsigned int ppuX, unsigned int ppuY, uint8_t unitSpecifi
     else
         m_state = true;
 
-    uint8_t *ppuXArrayPtr = Utilities::int_to_uint8(m_ppuX);
-    uint8_t *ppuYArrayPtr = Utilities::int_to_uint8(m_ppuY); 
-
-    uint8_t *cat_r1 = Utilities::getConcatenedArray(this->m_type, ppuXArrayPtr, 4, 4);
-    uint8_t *cat_r2 = Utilities::getConcatenedArray(ppuYArrayPtr, &m_unitSpecifier, 4, 1);
-
-    //the crc32 calculation algorithm needs the concatened array of the chunk type and the chunk datas
-    uint8_t *dataCRC = Utilities::getConcatenedArray(cat_r1, cat_r2, 4 + 4, 4 + 1);
-
-    m_crc32 = CRC32::getCRC32(dataCRC, 5 + 2*4);     //we calculate the crc and write it into the file stream
-    delete[] ppuXArrayPtr;    delete[] ppuYArrayPtr;    delete[] dataCRC;
-    delete[] cat_r1; delete[] cat_r2;
+    //the crc32 covers the chunk type followed by the chunk datas
+    uint8_t datas[9];
+    get_datas(datas);
+    m_crc32 = CRC32::update(CRC32::update(0, this->m_type, 4), datas, 9);
 }
 
 /**
@@ -58,28 +50,27 @@ PHYS_CHUNK::~PHYS_CHUNK()
 }
 
 /**
- * @brief save the actual PHYS_CHUNK datas(type, length, datas, crc32) to an output file stream
+ * @brief save the actual PHYS_CHUNK datas(type, length, datas, crc32) to an output sink
  * 
- * @param outputStream the output file stream reference
+ * @param sink the output sink reference
  */
-void PHYS_CHUNK::save(std::ofstream &outputStream)
+void PHYS_CHUNK::save(OutputSink &sink)
 {
-    //we start by converting the (> 1 byte) values into arrays of bytes
-    uint8_t *lengthArrayPtr = Utilities::int_to_uint8(m_length);
-    uint8_t *ppuXArrayPtr = Utilities::int_to_uint8(m_ppuX);
-    uint8_t *ppuYArrayPtr = Utilities::int_to_uint8(m_ppuY);
-    uint8_t *crc32ArrayPtr = Utilities::int_to_uint8(m_crc32);
-
-    //then we write chunk datas in the file stream
-    Utilities::stream_write(lengthArrayPtr, 4, outputStream);
-    Utilities::stream_write(this->m_type, 4, outputStream);
-    Utilities::stream_write(ppuXArrayPtr, 4, outputStream);
-    Utilities::stream_write(ppuYArrayPtr, 4, outputStream);
-    Utilities::stream_write(&m_unitSpecifier, 1, outputStream);
-    Utilities::stream_write(crc32ArrayPtr, 4, outputStream);
+    uint8_t datas[9];
+    get_datas(datas);
+    sink.write_chunk(this->m_type, datas, m_length, m_crc32);
+}
 
-    delete[] lengthArrayPtr;    delete[] crc32ArrayPtr; //freeing the bytes arrays
-    delete[] ppuXArrayPtr;     delete[] ppuYArrayPtr;
+/**
+ * @brief get the chunk datas, as written in the png file
+ * 
+ * @param datas the output, 9 bytes : pixels per unit on x and y axis (big endian) then the unit specifier
+ */
+void PHYS_CHUNK::get_datas(uint8_t *datas) const noexcept
+{
+    Utilities::write_be32(datas, m_ppuX);
+    Utilities::write_be32(datas + 4, m_ppuY);
+    datas[8] = m_unitSpecifier;
 }
 
 /**
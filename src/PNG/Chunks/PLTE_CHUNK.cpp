@@ -0,0 +1,70 @@
+#include <iostream>
+#include <cstring>
+
+#include "../../../include/PNG/CRC32.h"
+#include "../../../include/PNG/Chunks/PLTE_CHUNK.h"
+
+
+/**
+ * @brief Construct a new PLTE_CHUNK::PLTE_CHUNK object
+ * 
+ * @param colors the RGB colors of the palette entries, 3 bytes per entry
+ * @param entries the number of palette entries, from 1 to 256
+ */
+PLTE_CHUNK::PLTE_CHUNK(const uint8_t *colors, int entries)
+{
+    m_length = 3 * entries;               // setting up the PLTE chunk data length (3 bytes per entry)
+
+    this->m_type = new uint8_t[4];        // setting up the PLTE type (PLTE in Hexadecimal)
+    this->m_type[0] = 0x50; //P
+    this->m_type[1] = 0x4C; //L
+    this->m_type[2] = 0x54; //T
+    this->m_type[3] = 0x45; //E
+
+    m_data = new uint8_t[m_length];
+    std::memcpy(m_data, colors, m_length);
+
+    //the crc32 covers the chunk type followed by the chunk datas
+    m_crc32 = CRC32::update(CRC32::update(0, this->m_type, 4), m_data, m_length);
+}
+
+/**
+ * @brief Destroy the PLTE_CHUNK::PLTE_CHUNK object
+ * 
+ */
+PLTE_CHUNK::~PLTE_CHUNK()
+{
+    delete[] this->m_type;
+    delete[] this->m_data;
+}
+
+/**
+ * @brief save the actual PLTE_CHUNK datas(type, length, datas, crc32) to an output sink
+ * 
+ * @param sink the output sink reference
+ */
+void PLTE_CHUNK::save(OutputSink &sink)
+{
+    sink.write_chunk(this->m_type, m_data, m_length, m_crc32);
+}
+
+/**
+ * @brief get the number of palette entries
+ * 
+ * @return int 
+ */
+int PLTE_CHUNK::get_entries() const noexcept
+{
+    return m_length / 3;
+}
+
+/**
+ * @brief get the smallest bit depth able to store the palette indices
+ * 
+ * @return uint8_t 1, 2, 4 or 8
+ */
+uint8_t PLTE_CHUNK::get_bitDepth() const noexcept
+{
+    int entries = get_entries();
+    return (entries <= 2) ? 1 : (entries <= 4) ? 2 : (entries <= 16) ? 4 : 8;
+}
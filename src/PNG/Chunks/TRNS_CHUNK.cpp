@@ -0,0 +1,49 @@
+#include <iostream>
+#include <cstring>
+
+#include "../../../include/PNG/CRC32.h"
+#include "../../../include/PNG/Chunks/TRNS_CHUNK.h"
+
+
+/**
+ * @brief Construct a new TRNS_CHUNK::TRNS_CHUNK object
+ * 
+ * @param alphas the alpha values of the first palette entries, the following entries are opaque
+ * @param entries the number of alpha values, from 1 to the palette size
+ */
+TRNS_CHUNK::TRNS_CHUNK(const uint8_t *alphas, int entries)
+{
+    m_length = entries;                   // setting up the tRNS chunk data length (1 byte per entry)
+
+    this->m_type = new uint8_t[4];        // setting up the tRNS type (tRNS in Hexadecimal)
+    this->m_type[0] = 0x74; //t
+    this->m_type[1] = 0x52; //R
+    this->m_type[2] = 0x4E; //N
+    this->m_type[3] = 0x53; //S
+
+    m_data = new uint8_t[m_length];
+    std::memcpy(m_data, alphas, m_length);
+
+    //the crc32 covers the chunk type followed by the chunk datas
+    m_crc32 = CRC32::update(CRC32::update(0, this->m_type, 4), m_data, m_length);
+}
+
+/**
+ * @brief Destroy the TRNS_CHUNK::TRNS_CHUNK object
+ * 
+ */
+TRNS_CHUNK::~TRNS_CHUNK()
+{
+    delete[] this->m_type;
+    delete[] this->m_data;
+}
+
+/**
+ * @brief save the actual TRNS_CHUNK datas(type, length, datas, crc32) to an output sink
+ * 
+ * @param sink the output sink reference
+ */
+void TRNS_CHUNK::save(OutputSink &sink)
+{
+    sink.write_chunk(this->m_type, m_data, m_length, m_crc32);
+}
@@ -0,0 +1,769 @@
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#include "../../include/PNG/Filters.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define FILTERS_X86_SIMD 1
+    #include <immintrin.h>
+#endif
+
+namespace
+{
+    using unfilter_kernel = void (*)(uint8_t *line, const uint8_t *prev_line, int lineLength);
+    using filter_kernel = void (*)(uint8_t *line_out, const uint8_t *line, const uint8_t *prev_line, int lineLength, uint8_t filterMode, int bpp);
+    using score_kernel = void (*)(const uint8_t *line, const uint8_t *prev_line, int lineLength, int bpp, uint64_t *scores);
+    using swap_kernel = void (*)(uint8_t *line_out, const uint8_t *line, int lineLength);
+
+    /**
+     * @brief set of unfiltering kernels, indexed by bytes per pixel (1 to 8)
+     */
+    struct Kernels
+    {
+        Filters::SimdLevel level;
+        unfilter_kernel sub[9];
+        unfilter_kernel up[9];
+        unfilter_kernel avg[9];
+        unfilter_kernel paeth[9];
+        filter_kernel filter;
+        score_kernel score;
+        swap_kernel swap16;
+    };
+
+    /*
+     * Scalar kernels, also used for the bpp and the line tails which are not vectorized
+     */
+
+    // same choice as Utilities::paeth_predictor, written as two selections so that it compiles without branches
+    inline int paeth_predictor(int a, int b, int c)
+    {
+        int p_a = std::abs(b - c), p_b = std::abs(a - c), p_c = std::abs(a + b - 2 * c);
+        int nearest = (p_b < p_a) ? b : a;
+        int p_nearest = (p_b < p_a) ? p_b : p_a;
+        return (p_c < p_nearest) ? c : nearest;
+    }
+
+    template <int bpp>
+    void sub_scalar(uint8_t *line, const uint8_t *, int lineLength)
+    {
+        for (int i = bpp; i < lineLength; ++i)
+            line[i] = static_cast<uint8_t>(line[i] + line[i - bpp]);
+    }
+
+    template <int bpp>
+    void up_scalar(uint8_t *line, const uint8_t *prev_line, int lineLength)
+    {
+        for (int i = 0; i < lineLength; ++i)
+            line[i] = static_cast<uint8_t>(line[i] + prev_line[i]);
+    }
+
+    template <int bpp>
+    void avg_scalar(uint8_t *line, const uint8_t *prev_line, int lineLength)
+    {
+        for (int i = 0; i < bpp && i < lineLength; ++i)
+            line[i] = static_cast<uint8_t>(line[i] + (prev_line[i] >> 1));
+        for (int i = bpp; i < lineLength; ++i)
+            line[i] = static_cast<uint8_t>(line[i] + ((line[i - bpp] + prev_line[i]) >> 1));
+    }
+
+    template <int bpp>
+    void paeth_scalar(uint8_t *line, const uint8_t *prev_line, int lineLength)
+    {
+        for (int i = 0; i < bpp && i < lineLength; ++i)
+            line[i] = static_cast<uint8_t>(line[i] + prev_line[i]);
+        for (int i = bpp; i < lineLength; ++i)
+            line[i] = static_cast<uint8_t>(line[i] + paeth_predictor(line[i - bpp], prev_line[i], prev_line[i - bpp]));
+    }
+
+    // filtering has no dependency between bytes, the scalar versions also handle the heads and tails of the vectorized ones
+    template <uint8_t filterMode>
+    void filter_range(uint8_t *line_out, const uint8_t *line, const uint8_t *prev_line, int begin, int end, int bpp)
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            int a = (i >= bpp) ? line[i - bpp] : 0, b = prev_line[i], c = (i >= bpp) ? prev_line[i - bpp] : 0;
+            int prediction(0);
+            if constexpr (filterMode == 0x1)
+                prediction = a;
+            else if constexpr (filterMode == 0x2)
+                prediction = b;
+            else if constexpr (filterMode == 0x3)
+                prediction = (a + b) >> 1;
+            else if constexpr (filterMode == 0x4)
+                prediction = paeth_predictor(a, b, c);
+            line_out[i] = static_cast<uint8_t>(line[i] - prediction);
+        }
+    }
+
+    void filter_range(uint8_t *line_out, const uint8_t *line, const uint8_t *prev_line, int begin, int end, uint8_t filterMode, int bpp)
+    {
+        switch (filterMode)
+        {
+            case 0x0: filter_range<0x0>(line_out, line, prev_line, begin, end, bpp); break;
+            case 0x1: filter_range<0x1>(line_out, line, prev_line, begin, end, bpp); break;
+            case 0x2: filter_range<0x2>(line_out, line, prev_line, begin, end, bpp); break;
+            case 0x3: filter_range<0x3>(line_out, line, prev_line, begin, end, bpp); break;
+            case 0x4: filter_range<0x4>(line_out, line, prev_line, begin, end, bpp); break;
+        }
+    }
+
+    void filter_scalar(uint8_t *line_out, const uint8_t *line, const uint8_t *prev_line, int lineLength, uint8_t filterMode, int bpp)
+    {
+        filter_range(line_out, line, prev_line, 0, lineLength, filterMode, bpp);
+    }
+
+    // a filtered byte is scored as a signed value : 255 is as cheap as 1 for the deflate
+    inline int abs_signed(int value)
+    {
+        return std::abs(static_cast<int>(static_cast<int8_t>(static_cast<uint8_t>(value))));
+    }
+
+    void score_range(const uint8_t *line, const uint8_t *prev_line, int begin, int end, int bpp, uint64_t *scores)
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            int x = line[i], a = (i >= bpp) ? line[i - bpp] : 0, b = prev_line[i], c = (i >= bpp) ? prev_line[i - bpp] : 0;
+            scores[0] += abs_signed(x);
+            scores[1] += abs_signed(x - a);
+            scores[2] += abs_signed(x - b);
+            scores[3] += abs_signed(x - ((a + b) >> 1));
+            scores[4] += abs_signed(x - paeth_predictor(a, b, c));
+        }
+    }
+
+    void score_scalar(const uint8_t *line, const uint8_t *prev_line, int lineLength, int bpp, uint64_t *scores)
+    {
+        score_range(line, prev_line, 0, lineLength, bpp, scores);
+    }
+
+    void swap16_scalar(uint8_t *line_out, const uint8_t *line, int lineLength)
+    {
+        for (int i = 0; i + 2 <= lineLength; i += 2)
+        {
+            uint8_t high = line[i];
+            line_out[i] = line[i + 1];
+            line_out[i + 1] = high;
+        }
+    }
+
+#ifdef FILTERS_X86_SIMD
+
+    /*
+     * SSE2 unfiltering kernels
+     * Sub uses a prefix sum inside each vector when a pixel divides 16 bytes (bpp 1, 2, 4, 8),
+     * Sub(bpp 3, 6), Average and Paeth keep one pixel in a register and walk the line pixel by pixel.
+     */
+
+    // pixels are moved through general registers, a partial write then a wide read of the same memory would stall the store forwarding
+    template <int bpp>
+    __attribute__((target("sse2"))) inline __m128i load_pixel(const uint8_t *ptr)
+    {
+        if constexpr (bpp == 3)
+        {
+            uint16_t low(0);
+            std::memcpy(&low, ptr, 2);
+            return _mm_cvtsi32_si128(low | (ptr[2] << 16));
+        }
+        else if constexpr (bpp == 4)
+        {
+            int value(0);
+            std::memcpy(&value, ptr, 4);
+            return _mm_cvtsi32_si128(value);
+        }
+        else if constexpr (bpp == 6)
+        {
+            int low(0);
+            uint16_t high(0);
+            std::memcpy(&low, ptr, 4);
+            std::memcpy(&high, ptr + 4, 2);
+            return _mm_unpacklo_epi32(_mm_cvtsi32_si128(low), _mm_cvtsi32_si128(high));
+        }
+        else if constexpr (bpp == 8)
+            return _mm_loadl_epi64(reinterpret_cast<const __m128i *>(ptr));
+        else
+        {
+            uint64_t value(0);
+            std::memcpy(&value, ptr, bpp);
+            return _mm_loadl_epi64(reinterpret_cast<const __m128i *>(&value));
+        }
+    }
+
+    template <int bpp>
+    __attribute__((target("sse2"))) inline void store_pixel(uint8_t *ptr, __m128i pixel)
+    {
+        if constexpr (bpp == 3)
+        {
+            int value = _mm_cvtsi128_si32(pixel);
+            std::memcpy(ptr, &value, 2);
+            ptr[2] = static_cast<uint8_t>(value >> 16);
+        }
+        else if constexpr (bpp == 4)
+        {
+            int value = _mm_cvtsi128_si32(pixel);
+            std::memcpy(ptr, &value, 4);
+        }
+        else if constexpr (bpp == 6)
+        {
+            int low = _mm_cvtsi128_si32(pixel), high = _mm_cvtsi128_si32(_mm_srli_si128(pixel, 4));
+            std::memcpy(ptr, &low, 4);
+            std::memcpy(ptr + 4, &high, 2);
+        }
+        else if constexpr (bpp == 8)
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(ptr), pixel);
+        else
+        {
+            uint64_t value(0);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(&value), pixel);
+            std::memcpy(ptr, &value, bpp);
+        }
+    }
+
+    // broadcasting the last pixel of a vector to all its pixels
+    template <int bpp>
+    __attribute__((target("sse2"))) inline __m128i broadcast_last(__m128i v)
+    {
+        if constexpr (bpp == 1)
+        {
+            v = _mm_unpackhi_epi8(v, v);
+            v = _mm_shufflehi_epi16(v, 0xFF);
+            return _mm_unpackhi_epi64(v, v);
+        }
+        else if constexpr (bpp == 2)
+        {
+            v = _mm_shufflehi_epi16(v, 0xFF);
+            return _mm_unpackhi_epi64(v, v);
+        }
+        else if constexpr (bpp == 4)
+            return _mm_shuffle_epi32(v, 0xFF);
+        else
+            return _mm_unpackhi_epi64(v, v);
+    }
+
+    // prefix sum of the pixels of a vector (each pixel receives the sum of itself and all its left pixels)
+    template <int bpp>
+    __attribute__((target("sse2"))) inline __m128i prefix_sum(__m128i v)
+    {
+        v = _mm_add_epi8(v, _mm_slli_si128(v, bpp));
+        if constexpr (2 * bpp < 16)
+            v = _mm_add_epi8(v, _mm_slli_si128(v, 2 * bpp));
+        if constexpr (4 * bpp < 16)
+            v = _mm_add_epi8(v, _mm_slli_si128(v, 4 * bpp));
+        if constexpr (8 * bpp < 16)
+            v = _mm_add_epi8(v, _mm_slli_si128(v, 8 * bpp));
+        return v;
+    }
+
+    template <int bpp>
+    __attribute__((target("sse2"))) void sub_sse2(uint8_t *line, const uint8_t *, int lineLength)
+    {
+        int i(0);
+        if constexpr (16 % bpp == 0)
+        {
+            __m128i carry = _mm_setzero_si128();
+            for (; i + 16 <= lineLength; i += 16)
+            {
+                __m128i v = prefix_sum<bpp>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(line + i)));
+                v = _mm_add_epi8(v, carry);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(line + i), v);
+                carry = broadcast_last<bpp>(v);
+            }
+            for (i = (i == 0) ? bpp : i; i < lineLength; ++i)
+                line[i] = static_cast<uint8_t>(line[i] + line[i - bpp]);
+        }
+        else
+        {
+            __m128i a = _mm_setzero_si128();
+            for (; i + bpp <= lineLength; i += bpp)
+            {
+                a = _mm_add_epi8(load_pixel<bpp>(line + i), a);
+                store_pixel<bpp>(line + i, a);
+            }
+        }
+    }
+
+    template <int bpp>
+    __attribute__((target("sse2"))) void up_sse2(uint8_t *line, const uint8_t *prev_line, int lineLength)
+    {
+        int i(0);
+        for (; i + 16 <= lineLength; i += 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(line + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(prev_line + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(line + i), _mm_add_epi8(v, b));
+        }
+        for (; i < lineLength; ++i)
+            line[i] = static_cast<uint8_t>(line[i] + prev_line[i]);
+    }
+
+    template <int bpp>
+    __attribute__((target("sse2"))) void avg_sse2(uint8_t *line, const uint8_t *prev_line, int lineLength)
+    {
+        const __m128i one = _mm_set1_epi8(1);
+        __m128i a = _mm_setzero_si128();
+        for (int i = 0; i + bpp <= lineLength; i += bpp)
+        {
+            __m128i b = load_pixel<bpp>(prev_line + i);
+            // _mm_avg_epu8 rounds up, the png average rounds down
+            __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+            a = _mm_add_epi8(load_pixel<bpp>(line + i), avg);
+            store_pixel<bpp>(line + i, a);
+        }
+    }
+
+    __attribute__((target("sse2"))) inline __m128i if_then_else(__m128i condition, __m128i then_v, __m128i else_v)
+    {
+        return _mm_or_si128(_mm_and_si128(condition, then_v), _mm_andnot_si128(condition, else_v));
+    }
+
+    __attribute__((target("sse2"))) inline __m128i abs_epi16(__m128i v)
+    {
+        return _mm_max_epi16(v, _mm_sub_epi16(_mm_setzero_si128(), v));
+    }
+
+    // paeth predictor on 16 bits lanes, p - a = b - c, p - b = a - c and p - c = (b - c) + (a - c)
+    __attribute__((target("sse2"))) inline __m128i paeth_epi16(__m128i a, __m128i b, __m128i c)
+    {
+        __m128i p_a = _mm_sub_epi16(b, c);
+        __m128i p_b = _mm_sub_epi16(a, c);
+        __m128i p_c = abs_epi16(_mm_add_epi16(p_a, p_b));
+        p_a = abs_epi16(p_a);
+        p_b = abs_epi16(p_b);
+
+        // ties are broken favoring a over b over c
+        __m128i smallest = _mm_min_epi16(p_c, _mm_min_epi16(p_a, p_b));
+        return if_then_else(_mm_cmpeq_epi16(smallest, p_a), a, if_then_else(_mm_cmpeq_epi16(smallest, p_b), b, c));
+    }
+
+    template <int bpp>
+    __attribute__((target("sse2"))) void paeth_sse2(uint8_t *line, const uint8_t *prev_line, int lineLength)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i a = zero, c = zero;
+        for (int i = 0; i + bpp <= lineLength; i += bpp)
+        {
+            __m128i b = _mm_unpacklo_epi8(load_pixel<bpp>(prev_line + i), zero);
+            __m128i nearest = paeth_epi16(a, b, c);
+
+            __m128i x = _mm_add_epi8(load_pixel<bpp>(line + i), _mm_packus_epi16(nearest, nearest));
+            store_pixel<bpp>(line + i, x);
+
+            a = _mm_unpacklo_epi8(x, zero);
+            c = b;
+        }
+    }
+
+    /*
+     * SSE2 filtering kernels, the whole line is known then 16 bytes are filtered at once.
+     * The first 16 bytes are filtered by the scalar code, so that the left pixels (line - bpp) can always be loaded.
+     */
+
+    __attribute__((target("sse2"))) inline __m128i avg_floor_epu8(__m128i a, __m128i b)
+    {
+        return _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1)));
+    }
+
+    __attribute__((target("sse2"))) inline __m128i paeth_epu8(__m128i a, __m128i b, __m128i c)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i low = paeth_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(c, zero));
+        __m128i high = paeth_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(c, zero));
+        return _mm_packus_epi16(low, high);
+    }
+
+    // absolute values of the bytes taken as signed values, then summed
+    __attribute__((target("sse2"))) inline __m128i sum_abs_signed(__m128i v)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        return _mm_sad_epu8(_mm_min_epu8(v, _mm_sub_epi8(zero, v)), zero);
+    }
+
+    template <uint8_t filterMode>
+    __attribute__((target("sse2"))) void filter_sse2(uint8_t *line_out, const uint8_t *line, const uint8_t *prev_line, int lineLength, int bpp)
+    {
+        int i = (lineLength < 16) ? lineLength : 16;
+        filter_range<filterMode>(line_out, line, prev_line, 0, i, bpp);
+
+        for (; i + 16 <= lineLength; i += 16)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(line + i));
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(line + i - bpp));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(prev_line + i));
+
+            __m128i prediction;
+            if constexpr (filterMode == 0x0)
+                prediction = _mm_setzero_si128();
+            else if constexpr (filterMode == 0x1)
+                prediction = a;
+            else if constexpr (filterMode == 0x2)
+                prediction = b;
+            else if constexpr (filterMode == 0x3)
+                prediction = avg_floor_epu8(a, b);
+            else
+                prediction = paeth_epu8(a, b, _mm_loadu_si128(reinterpret_cast<const __m128i *>(prev_line + i - bpp)));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(line_out + i), _mm_sub_epi8(x, prediction));
+        }
+        filter_range<filterMode>(line_out, line, prev_line, i, lineLength, bpp);
+    }
+
+    __attribute__((target("sse2"))) void filter_sse2(uint8_t *line_out, const uint8_t *line, const uint8_t *prev_line, int lineLength, uint8_t filterMode, int bpp)
+    {
+        switch (filterMode)
+        {
+            case 0x0: filter_sse2<0x0>(line_out, line, prev_line, lineLength, bpp); break;
+            case 0x1: filter_sse2<0x1>(line_out, line, prev_line, lineLength, bpp); break;
+            case 0x2: filter_sse2<0x2>(line_out, line, prev_line, lineLength, bpp); break;
+            case 0x3: filter_sse2<0x3>(line_out, line, prev_line, lineLength, bpp); break;
+            case 0x4: filter_sse2<0x4>(line_out, line, prev_line, lineLength, bpp); break;
+        }
+    }
+
+    // the 5 filters are scored in a single pass over the line, without writing any filtered line
+    __attribute__((target("sse2"))) void score_sse2(const uint8_t *line, const uint8_t *prev_line, int lineLength, int bpp, uint64_t *scores)
+    {
+        int i = (lineLength < 16) ? lineLength : 16;
+        score_range(line, prev_line, 0, i, bpp, scores);
+
+        __m128i sums[5] = {_mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128()};
+        for (; i + 16 <= lineLength; i += 16)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(line + i));
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(line + i - bpp));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(prev_line + i));
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(prev_line + i - bpp));
+
+            sums[0] = _mm_add_epi64(sums[0], sum_abs_signed(x));
+            sums[1] = _mm_add_epi64(sums[1], sum_abs_signed(_mm_sub_epi8(x, a)));
+            sums[2] = _mm_add_epi64(sums[2], sum_abs_signed(_mm_sub_epi8(x, b)));
+            sums[3] = _mm_add_epi64(sums[3], sum_abs_signed(_mm_sub_epi8(x, avg_floor_epu8(a, b))));
+            sums[4] = _mm_add_epi64(sums[4], sum_abs_signed(_mm_sub_epi8(x, paeth_epu8(a, b, c))));
+        }
+        score_range(line, prev_line, i, lineLength, bpp, scores);
+
+        for (int filterMode = 0; filterMode < 5; ++filterMode)
+        {
+            uint64_t halves[2];
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(halves), sums[filterMode]);
+            scores[filterMode] += halves[0] + halves[1];
+        }
+    }
+
+    /*
+     * AVX2 unfiltering kernels, Up and the prefix sum Sub. Average and Paeth carry a dependency from one pixel to the next,
+     * then a wider register doesn't help them.
+     */
+
+    template <int bpp>
+    __attribute__((target("avx2"))) inline __m256i broadcast_last_256(__m256i v)
+    {
+        // same as broadcast_last(), but inside each 128 bits lane
+        if constexpr (bpp == 1)
+        {
+            v = _mm256_unpackhi_epi8(v, v);
+            v = _mm256_shufflehi_epi16(v, 0xFF);
+            return _mm256_unpackhi_epi64(v, v);
+        }
+        else if constexpr (bpp == 2)
+        {
+            v = _mm256_shufflehi_epi16(v, 0xFF);
+            return _mm256_unpackhi_epi64(v, v);
+        }
+        else if constexpr (bpp == 4)
+            return _mm256_shuffle_epi32(v, 0xFF);
+        else
+            return _mm256_unpackhi_epi64(v, v);
+    }
+
+    template <int bpp>
+    __attribute__((target("avx2"))) void sub_avx2(uint8_t *line, const uint8_t *, int lineLength)
+    {
+        int i(0);
+        __m256i carry = _mm256_setzero_si256();
+        for (; i + 32 <= lineLength; i += 32)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(line + i));
+
+            // prefix sum inside each lane
+            v = _mm256_add_epi8(v, _mm256_slli_si256(v, bpp));
+            if constexpr (2 * bpp < 16)
+                v = _mm256_add_epi8(v, _mm256_slli_si256(v, 2 * bpp));
+            if constexpr (4 * bpp < 16)
+                v = _mm256_add_epi8(v, _mm256_slli_si256(v, 4 * bpp));
+            if constexpr (8 * bpp < 16)
+                v = _mm256_add_epi8(v, _mm256_slli_si256(v, 8 * bpp));
+
+            // the last pixel of the low lane is propagated to the high lane, then the previous vector carry to both
+            __m256i low_last = broadcast_last_256<bpp>(_mm256_permute2x128_si256(v, v, 0x08));
+            v = _mm256_add_epi8(_mm256_add_epi8(v, low_last), carry);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(line + i), v);
+
+            carry = broadcast_last_256<bpp>(_mm256_permute2x128_si256(v, v, 0x11));
+        }
+        for (i = (i == 0) ? bpp : i; i < lineLength; ++i)
+            line[i] = static_cast<uint8_t>(line[i] + line[i - bpp]);
+    }
+
+    template <int bpp>
+    __attribute__((target("avx2"))) void up_avx2(uint8_t *line, const uint8_t *prev_line, int lineLength)
+    {
+        int i(0);
+        for (; i + 32 <= lineLength; i += 32)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(line + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(prev_line + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(line + i), _mm256_add_epi8(v, b));
+        }
+        for (; i < lineLength; ++i)
+            line[i] = static_cast<uint8_t>(line[i] + prev_line[i]);
+    }
+
+    __attribute__((target("sse2"))) void swap16_sse2(uint8_t *line_out, const uint8_t *line, int lineLength)
+    {
+        int i(0);
+        for (; i + 16 <= lineLength; i += 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(line + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(line_out + i), _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+        }
+        swap16_scalar(line_out + i, line + i, lineLength - i);
+    }
+
+    __attribute__((target("avx2"))) void swap16_avx2(uint8_t *line_out, const uint8_t *line, int lineLength)
+    {
+        const __m256i order = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                               1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+        int i(0);
+        for (; i + 32 <= lineLength; i += 32)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(line + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(line_out + i), _mm256_shuffle_epi8(v, order));
+        }
+        swap16_scalar(line_out + i, line + i, lineLength - i);
+    }
+
+#endif // FILTERS_X86_SIMD
+
+    template <int bpp>
+    void fill_kernels(Kernels &kernels, Filters::SimdLevel level)
+    {
+        kernels.sub[bpp] = sub_scalar<bpp>;
+        kernels.up[bpp] = up_scalar<bpp>;
+        kernels.avg[bpp] = avg_scalar<bpp>;
+        kernels.paeth[bpp] = paeth_scalar<bpp>;
+
+#ifdef FILTERS_X86_SIMD
+        // for 1 and 2 bytes per pixel, Average and Paeth depend on the previous byte, the scalar kernel is kept
+        constexpr bool pixel_wise{bpp >= 3};
+        constexpr bool prefix_sum{16 % bpp == 0};
+
+        if (level >= Filters::SimdLevel::SSE2)
+        {
+            kernels.up[bpp] = up_sse2<bpp>;
+            if constexpr (pixel_wise || prefix_sum)
+                kernels.sub[bpp] = sub_sse2<bpp>;
+            if constexpr (pixel_wise)
+            {
+                kernels.avg[bpp] = avg_sse2<bpp>;
+                kernels.paeth[bpp] = paeth_sse2<bpp>;
+            }
+        }
+        if (level >= Filters::SimdLevel::AVX2)
+        {
+            kernels.up[bpp] = up_avx2<bpp>;
+            if constexpr (prefix_sum)
+                kernels.sub[bpp] = sub_avx2<bpp>;
+        }
+#endif
+    }
+
+    Filters::SimdLevel get_supported_level() noexcept
+    {
+#ifdef FILTERS_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return Filters::SimdLevel::AVX2;
+        if (__builtin_cpu_supports("sse2"))
+            return Filters::SimdLevel::SSE2;
+#endif
+        return Filters::SimdLevel::SCALAR;
+    }
+
+    Kernels select_kernels(Filters::SimdLevel level) noexcept
+    {
+        if (level > get_supported_level())
+            level = get_supported_level();
+
+        Kernels kernels;
+        kernels.level = level;
+        kernels.filter = filter_scalar;
+        kernels.score = score_scalar;
+        kernels.swap16 = swap16_scalar;
+#ifdef FILTERS_X86_SIMD
+        if (level >= Filters::SimdLevel::SSE2)
+        {
+            kernels.filter = filter_sse2;
+            kernels.score = score_sse2;
+            kernels.swap16 = swap16_sse2;
+        }
+        if (level >= Filters::SimdLevel::AVX2)
+            kernels.swap16 = swap16_avx2;
+#endif
+        fill_kernels<1>(kernels, level); fill_kernels<2>(kernels, level);
+        fill_kernels<3>(kernels, level); fill_kernels<4>(kernels, level);
+        fill_kernels<5>(kernels, level); fill_kernels<6>(kernels, level);
+        fill_kernels<7>(kernels, level); fill_kernels<8>(kernels, level);
+        return kernels;
+    }
+
+    Kernels &get_kernels() noexcept
+    {
+        static Kernels kernels = select_kernels(get_supported_level()); // best kernels for the running cpu
+        return kernels;
+    }
+}
+
+
+/**
+ * @brief unfiltering line method, in place
+ * @details png format has many filtering options for improving the compression(deflate)
+ * then after decompression(inflate), datas needs to be unfiltered, according to the specified filter method
+ * @note filtering and unfiltering methods are applied one each line.
+ *
+ * @param line the line to unfilter, overwritten by the unfiltered values
+ * @param prev_line the predecessor line (already unfiltered), a line of 0 for the first line
+ * @param lineLength the line length
+ * @param filterMode the filter mode of the actual line ( 0 = none, 1 = Sub, 2 = Up, 3 = Average, 4 = Paeth)
+ * @param bpp the number of bytes per pixel, from 1 to 8
+ *
+ * @exception std::invalid_argument case Invalid filter mode or bytes per pixel
+ */
+void Filters::unfilter_line(uint8_t *line, const uint8_t *prev_line, int lineLength, uint8_t filterMode, int bpp)
+{
+    if (bpp < 1 || bpp > 8)
+        throw std::invalid_argument("Invalid bytes per pixel number : " + std::to_string(bpp));
+
+    const Kernels &kernels = get_kernels();
+    switch (filterMode)
+    {
+    case 0x0: // filter mode 0(none), nothing to do
+        break;
+
+    case 0x1: // filter mode 1(Sub)
+        kernels.sub[bpp](line, prev_line, lineLength);
+        break;
+
+    case 0x2: // filter mode 2(Up)
+        kernels.up[bpp](line, prev_line, lineLength);
+        break;
+
+    case 0x3: // filter mode 3(Average)
+        kernels.avg[bpp](line, prev_line, lineLength);
+        break;
+
+    case 0x4: // filter mode 4(Paeth)
+        kernels.paeth[bpp](line, prev_line, lineLength);
+        break;
+
+    default:
+        throw std::invalid_argument("Invalid filter mode is specified : 0x" + std::to_string(filterMode));
+        break;
+    }
+}
+
+/**
+ * @brief filtering line method
+ * @details png format has many filtering options for improving the compression(deflate)
+ * @note filtering and unfiltering methods are applied one each line.
+ *
+ * @param line_out the filtered line output, lineLength bytes (the filter mode byte is not written)
+ * @param line the line to filter
+ * @param prev_line the predecessor line (not filtered), a line of 0 for the first line
+ * @param lineLength the line length
+ * @param filterMode the filter mode to apply ( 0 = none, 1 = Sub, 2 = Up, 3 = Average, 4 = Paeth)
+ * @param bpp the number of bytes per pixel, from 1 to 8
+ *
+ * @exception std::invalid_argument case Invalid filter mode or bytes per pixel
+ */
+void Filters::filter_line(uint8_t *line_out, const uint8_t *line, const uint8_t *prev_line, int lineLength, uint8_t filterMode, int bpp)
+{
+    if (bpp < 1 || bpp > 8)
+        throw std::invalid_argument("Invalid bytes per pixel number : " + std::to_string(bpp));
+    if (filterMode > 0x4)
+        throw std::invalid_argument("Invalid filter mode is specified : 0x" + std::to_string(filterMode));
+
+    get_kernels().filter(line_out, line, prev_line, lineLength, filterMode, bpp);
+}
+
+/**
+ * @brief scoring each filter mode for a line, with the minimum sum of absolute differences heuristic
+ * @details the 5 filters are computed in a single pass, each filtered byte counting as its absolute value taken as a signed byte.
+ * The lower the score is, the better the filtered line should be deflated.
+ *
+ * @param line the line to score
+ * @param prev_line the predecessor line (not filtered), a line of 0 for the first line
+ * @param lineLength the line length
+ * @param bpp the number of bytes per pixel, from 1 to 8
+ * @param scores the output scores, indexed by filter mode
+ */
+void Filters::score_filters(const uint8_t *line, const uint8_t *prev_line, int lineLength, int bpp, uint64_t scores[5])
+{
+    if (bpp < 1 || bpp > 8)
+        throw std::invalid_argument("Invalid bytes per pixel number : " + std::to_string(bpp));
+
+    for (int filterMode = 0; filterMode < 5; ++filterMode)
+        scores[filterMode] = 0;
+    get_kernels().score(line, prev_line, lineLength, bpp, scores);
+}
+
+/**
+ * @brief get the filter mode with the lowest score for a line
+ * @see Filters::score_filters
+ *
+ * @param line the line to filter
+ * @param prev_line the predecessor line (not filtered), a line of 0 for the first line
+ * @param lineLength the line length
+ * @param bpp the number of bytes per pixel, from 1 to 8
+ * @return uint8_t the best filter mode, the lowest one in case of equality
+ */
+uint8_t Filters::select_filter(const uint8_t *line, const uint8_t *prev_line, int lineLength, int bpp)
+{
+    uint64_t scores[5];
+    score_filters(line, prev_line, lineLength, bpp, scores);
+    return static_cast<uint8_t>(std::min_element(scores, scores + 5) - scores);
+}
+
+/**
+ * @brief swap the two bytes of each 16 bits sample of a line, from the png big endian order to the little endian order (or the reverse)
+ *
+ * @param line_out the swapped line output, can be the line itself
+ * @param line the line of 16 bits samples
+ * @param lineLength the line length, in bytes
+ */
+void Filters::swap_samples16(uint8_t *line_out, const uint8_t *line, int lineLength) noexcept
+{
+    get_kernels().swap16(line_out, line, lineLength);
+}
+
+/**
+ * @brief get the kernels implementation actually in use
+ *
+ * @return Filters::SimdLevel
+ */
+Filters::SimdLevel Filters::get_simd_level() noexcept
+{
+    return get_kernels().level;
+}
+
+/**
+ * @brief select a kernels implementation, mainly for benchmarking and debugging purposes
+ * @note the level is lowered to the best level supported by the running cpu.
+ * @warning not thread safe, should not be called while lines are being filtered or unfiltered.
+ *
+ * @param level the wanted kernels implementation
+ */
+void Filters::set_simd_level(SimdLevel level) noexcept
+{
+    get_kernels() = select_kernels(level);
+}
@@ -0,0 +1,191 @@
+#include <cstring>
+
+#include "../../include/PNG/Utilities.h"
+#include "../../include/PNG/OutputSink.h"
+
+
+/**
+ * @brief flush the pending datas, if the sink is buffered
+ *
+ */
+void OutputSink::flush()
+{
+}
+
+/**
+ * @brief write a chunk (length, type, datas, crc32), multi bytes values in big endian
+ *
+ * @param type the chunk type, 4 bytes
+ * @param datas the chunk datas
+ * @param len the chunk datas length
+ * @param crc32 the crc32 of the chunk type followed by the chunk datas
+ */
+void OutputSink::write_chunk(const uint8_t *type, const uint8_t *datas, uint32_t len, uint32_t crc32)
+{
+    uint8_t header[8], trailer[4];
+    Utilities::write_be32(header, len);
+    std::memcpy(header + 4, type, 4);
+    Utilities::write_be32(trailer, crc32);
+
+    write(header, 8);
+    if (len > 0)
+        write(datas, len);
+    write(trailer, 4);
+}
+
+
+/**
+ * @brief Construct a new FileSink::FileSink object, creating the file
+ *
+ * @param path the file path
+ *
+ * @exception std::runtime_error if cannot create file as specified path
+ */
+FileSink::FileSink(const std::string &path)
+{
+    m_file = std::fopen(path.c_str(), "wb");
+    if (m_file == nullptr)
+        throw std::runtime_error("Enable to create file at specified path : " + path);
+
+    std::setvbuf(m_file, nullptr, _IONBF, 0); // the sink does its own buffering
+    m_buffer.reserve(bufferSize);
+}
+
+/**
+ * @brief Destroy the FileSink::FileSink object, flushing and closing the file
+ * @warning write errors are ignored, call FileSink::close() for getting them.
+ *
+ */
+FileSink::~FileSink()
+{
+    try
+    {
+        close();
+    }
+    catch (const std::exception &)
+    {
+    }
+}
+
+/**
+ * @brief write datas in the file
+ * @details datas smaller than the buffer are gathered, larger ones are written with a single call.
+ *
+ * @param datas the datas to write
+ * @param len the datas length
+ *
+ * @exception std::runtime_error if cannot write in the file
+ */
+void FileSink::write(const uint8_t *datas, std::size_t len)
+{
+    if (m_buffer.size() + len <= bufferSize)
+    {
+        m_buffer.insert(m_buffer.end(), datas, datas + len);
+        return;
+    }
+
+    flush();
+    if (len < bufferSize)
+        m_buffer.insert(m_buffer.end(), datas, datas + len);
+    else
+        write_file(datas, len);
+}
+
+/**
+ * @brief write the pending datas in the file
+ *
+ * @exception std::runtime_error if cannot write in the file
+ */
+void FileSink::flush()
+{
+    if (!m_buffer.empty())
+    {
+        write_file(m_buffer.data(), m_buffer.size());
+        m_buffer.clear();
+    }
+}
+
+/**
+ * @brief flush the pending datas and close the file
+ *
+ * @exception std::runtime_error if cannot write in the file
+ */
+void FileSink::close()
+{
+    if (m_file == nullptr)
+        return;
+
+    std::FILE *file = m_file;
+    try
+    {
+        flush();
+    }
+    catch (const std::exception &)
+    {
+        m_file = nullptr;
+        std::fclose(file);
+        throw;
+    }
+
+    m_file = nullptr;
+    if (std::fclose(file) != 0)
+        throw std::runtime_error("Enable to write the file");
+}
+
+/**
+ * @brief write datas in the file, without buffering
+ *
+ * @param datas the datas to write
+ * @param len the datas length
+ *
+ * @exception std::runtime_error if cannot write in the file
+ */
+void FileSink::write_file(const uint8_t *datas, std::size_t len)
+{
+    if (m_file == nullptr || std::fwrite(datas, 1, len, m_file) != len)
+        throw std::runtime_error("Enable to write the file");
+}
+
+
+/**
+ * @brief Construct a new MemorySink::MemorySink object
+ *
+ * @param output the vector in which bytes are appended
+ */
+MemorySink::MemorySink(std::vector<uint8_t> &output)
+    : m_output(output)
+{
+}
+
+/**
+ * @brief append datas to the output vector
+ *
+ * @param datas the datas to write
+ * @param len the datas length
+ */
+void MemorySink::write(const uint8_t *datas, std::size_t len)
+{
+    m_output.insert(m_output.end(), datas, datas + len);
+}
+
+
+/**
+ * @brief Construct a new CallbackSink::CallbackSink object
+ *
+ * @param callback the user function, called with each written datas
+ */
+CallbackSink::CallbackSink(Callback callback)
+    : m_callback(std::move(callback))
+{
+}
+
+/**
+ * @brief give datas to the user function
+ *
+ * @param datas the datas to write
+ * @param len the datas length
+ */
+void CallbackSink::write(const uint8_t *datas, std::size_t len)
+{
+    m_callback(datas, len);
+}
@@ -1,48 +1,43 @@
 
 #include "../../include/PNG/PNG.h"
 #include "../../include/zlib/zlib.h"
+#include "../../include/PNG/CRC32.h"
+#include "../../include/PNG/Adam7.h"
+#include "../../include/PNG/Palette.h"
 #include "../../include/PNG/Utilities.h"
+#include "../../include/PNG/ChunkWalker.h"
+#include "../../include/PNG/Filters.h"
+#include "../../include/PNG/PixelExpander.h"
+#include "../../include/PNG/ScanlineDecoder.h"
 
 
 /**
  * @brief Construct a new PNG::PNG object
  * 
- * @param pixelBuffer the input pixel buffer(raw values) of an image
+ * @param pixelBuffer the input pixel buffer(raw values) of an image, copied
  * @param s_width  the png width information 
  * @param s_height the png height information
  * @param bitDepth the png bit depth information
- * @param colorMode the png color mode information, only managed are 0(grayscale), 2(RGB true color) and 6(RGBA)
+ * @param colorMode the png color mode information, only managed are 0(grayscale), 4(grayscale alpha), 2(RGB true color) and 6(RGBA)
  * @param ppuX the physical pixel dimension (on x axis) of the png
  * @param ppuY the physical pixel value (on y axis) of the png
  * @param unitSpecifier the phisical pixel dimension unit of the png
+ * @param options the encoding options (zlib parameters and filter selection strategy)
  */
-PNG::PNG(const uint8_t *pixelBuffer, int s_width, int s_height, int bitDepth, int colorMode, unsigned int ppuX, unsigned int ppuY, uint8_t unitSpecifier)
+PNG::PNG(const uint8_t *pixelBuffer, int s_width, int s_height, int bitDepth, int colorMode, unsigned int ppuX, unsigned int ppuY, uint8_t unitSpecifier, const EncodeOptions &options)
+    : m_options(options)
 {
-    m_signature = new uint8_t[8]; // we assign the PNG signature
-    m_signature[0] = 0x89;
-    m_signature[1] = 0x50;
-    m_signature[2] = 0x4E;
-    m_signature[3] = 0x47;
-    m_signature[4] = 0x0D;
-    m_signature[5] = 0x0A;
-    m_signature[6] = 0x1A;
-    m_signature[7] = 0x0A;
-
     // setting up the colors channels number
-    uint8_t colorChannels {0};
-    if(colorMode == 0x0)
-        colorChannels = 1 * (bitDepth / 8);
-    if(colorMode == 0x1)
-        colorChannels = 2 * (bitDepth / 8);
-    else if (colorMode == 0x2)
-        colorChannels = 3 * (bitDepth / 8);
-    else if (colorMode == 0x6)
-        colorChannels = 4 * (bitDepth / 8);
+    uint8_t colorChannels = get_colorChannels(bitDepth, colorMode);
+
+    // the pixels are kept, so that the png can be encoded again (copy, save with other options)
+    int pixelsBufferLen = s_width * s_height * colorChannels;
+    m_pixelBuffer.reset(new uint8_t[pixelsBufferLen]);
+    memcpy(m_pixelBuffer.get(), pixelBuffer, pixelsBufferLen);
 
-    // setting up all the png Chunks, calling constructors
+    // setting up all the png Chunks, calling constructors, the IDAT chunk is only encoded when saving
     m_IHDR = new IHDR_CHUNK(s_width, s_height, bitDepth, colorMode);
     m_pHYs = new PHYS_CHUNK(ppuX, ppuY, unitSpecifier);
-    m_IDAT = new IDAT_CHUNK(pixelBuffer, s_width, s_height, colorChannels);
     m_IEND = new IEND_CHUNK();
 }
 
@@ -50,67 +45,45 @@ PNG::PNG(const uint8_t *pixelBuffer, int s_width, int s_height, int bitDepth, in
 /**
  * @brief Construct a new PNG::PNG object
  * 
- * @param pixelBuffer the input pixel buffer(raw values) of an image
+ * @param pixelBuffer the input pixel buffer(raw values) of an image, copied
  * @param s_width  the png width information 
  * @param s_height the png height information
  * @param bitDepth the png bit depth information
- * @param colorMode the png color mode information, only managed are 0(grayscale), 2(RGB true color) and 6(RGBA)
+ * @param colorMode the png color mode information, only managed are 0(grayscale), 4(grayscale alpha), 2(RGB true color) and 6(RGBA)
+ * @param options the encoding options (zlib parameters and filter selection strategy)
  */
-PNG::PNG(const uint8_t *pixelBuffer, int s_width, int s_height, int bitDepth, int colorMode)
+PNG::PNG(const uint8_t *pixelBuffer, int s_width, int s_height, int bitDepth, int colorMode, const EncodeOptions &options)
+    : PNG(pixelBuffer, s_width, s_height, bitDepth, colorMode, 0, 0, 0, options) // a null pHYs chunk disables its writing
 {
-    m_signature = new uint8_t[8]; // we assign the PNG signature
-    m_signature[0] = 0x89;
-    m_signature[1] = 0x50;
-    m_signature[2] = 0x4E;
-    m_signature[3] = 0x47;
-    m_signature[4] = 0x0D;
-    m_signature[5] = 0x0A;
-    m_signature[6] = 0x1A;
-    m_signature[7] = 0x0A;
-
-    uint8_t colorChannels {0};
-    if(colorMode == 0x0)
-        colorChannels = 1 * (bitDepth / 8);
-    if(colorMode == 0x1)
-        colorChannels = 2 * (bitDepth / 8);
-    else if (colorMode == 0x2)
-        colorChannels = 3 * (bitDepth / 8);
-    else if (colorMode == 0x6)
-        colorChannels = 4 * (bitDepth / 8);
-
-    // setting up all the png Chunks, calling constructors
-    m_IHDR = new IHDR_CHUNK(s_width, s_height, bitDepth, colorMode);
-    m_pHYs = new PHYS_CHUNK(0, 0, 0); // this will disable PHYS chunk writing
-    m_IDAT = new IDAT_CHUNK(pixelBuffer, s_width, s_height, colorChannels);
-    m_IEND = new IEND_CHUNK();
 }
 
 
 /**
  * @brief Construct a new PNG::PNG object (by copy)
+ * @details the pixels buffer and the encoded scanlines are shared with the copied png, they are only duplicated
+ * when the pixels of one of the png are changed.
+ * @see PNG::set_raw_pixels
  * 
  * @param png object to be copied
  */
 PNG::PNG(const PNG &png_src)
+    : m_pixelBuffer(png_src.m_pixelBuffer), m_IDAT(png_src.m_IDAT), m_PLTE(png_src.m_PLTE), m_tRNS(png_src.m_tRNS), m_options(png_src.m_options)
 {
-    this->m_signature = new uint8_t[8];
-    memcpy(this->m_signature, png_src.m_signature, 8);
+    m_IHDR = new IHDR_CHUNK(png_src.get_width(), png_src.get_height(), png_src.get_bitDepth(), png_src.get_colorMode());
+    m_pHYs = new PHYS_CHUNK(png_src.m_pHYs->m_ppuX, png_src.m_pHYs->m_ppuY, png_src.m_pHYs->m_unitSpecifier);
+    m_IEND = new IEND_CHUNK();
+}
 
-    this->m_IHDR = new IHDR_CHUNK(png_src.m_IHDR->m_width, png_src.m_IHDR->m_height, png_src.m_IHDR->m_data[0], png_src.m_IHDR->m_data[1]);
-    this->m_pHYs = new PHYS_CHUNK(png_src.m_pHYs->m_ppuX, png_src.m_pHYs->m_ppuY, png_src.m_pHYs->m_unitSpecifier);
 
-    uint8_t colorChannels {0};
-    if(png_src.m_IHDR->m_data[1] == 0x0)
-        colorChannels = 1 * (this->get_bitDepth() / 8);
-    if(png_src.m_IHDR->m_data[1] == 0x1)
-        colorChannels = 2 * (this->get_bitDepth() / 8);
-    else if (png_src.m_IHDR->m_data[1] == 0x2)
-        colorChannels = 3 * (this->get_bitDepth() / 8);
-    else if (png_src.m_IHDR->m_data[1] == 0x6)
-        colorChannels = 4 * (this->get_bitDepth() / 8);
-    
-    this->m_IDAT = new IDAT_CHUNK(png_src.m_pixelBuffer, png_src.m_IHDR->m_width, png_src.m_IHDR->m_height, colorChannels);
-    this->m_IEND = new IEND_CHUNK();
+/**
+ * @brief Construct a new PNG::PNG object (by move)
+ * @warning the moved png is left empty, it can only be destroyed or assigned.
+ * 
+ * @param png object to be moved
+ */
+PNG::PNG(PNG &&png_src) noexcept
+{
+    swap(png_src);
 }
 
 
@@ -122,63 +95,369 @@ PNG::PNG(const PNG &png_src)
  */
 PNG &PNG::operator=(const PNG &png_src)
 {
-    this->m_signature = new uint8_t[8];
-    memcpy(this->m_signature, png_src.m_signature, 8);
+    if (this == &png_src)
+        return *this;
 
-    this->m_IHDR = new IHDR_CHUNK(png_src.m_IHDR->m_width, png_src.m_IHDR->m_height, png_src.m_IHDR->m_data[0], png_src.m_IHDR->m_data[1]);
-    this->m_pHYs = new PHYS_CHUNK(png_src.m_pHYs->m_ppuX, png_src.m_pHYs->m_ppuY, png_src.m_pHYs->m_unitSpecifier);
+    PNG copy(png_src); // the current chunks are only released once the copy succeeded
+    swap(copy);
+
+    return *this;
+}
 
-    uint8_t colorChannels {0};
-    if(png_src.m_IHDR->m_data[1] == 0x0)
-        colorChannels = 1;
-    if(png_src.m_IHDR->m_data[1] == 0x1)
-        colorChannels = 2;
-    else if (png_src.m_IHDR->m_data[1] == 0x2)
-        colorChannels = 3;
-    else if (png_src.m_IHDR->m_data[1] == 0x6)
-        colorChannels = 4;
-    
-    this->m_IDAT = new IDAT_CHUNK(png_src.m_pixelBuffer, png_src.m_IHDR->m_width, png_src.m_IHDR->m_height, colorChannels);
-    this->m_IEND = new IEND_CHUNK();
 
+/**
+ * @brief move affectation operator overloading
+ * @warning the moved png is left with the previous chunks of this png, it can only be destroyed or assigned.
+ * 
+ * @param png_src object to be moved
+ * @return PNG object
+ */
+PNG &PNG::operator=(PNG &&png_src) noexcept
+{
+    swap(png_src);
     return *this;
 }
 
 
+/**
+ * @brief exchange the pixels, chunks and options of two png
+ * 
+ * @param png the png to exchange with
+ */
+void PNG::swap(PNG &png) noexcept
+{
+    std::swap(m_pixelBuffer, png.m_pixelBuffer);
+    std::swap(m_IHDR, png.m_IHDR);
+    std::swap(m_pHYs, png.m_pHYs);
+    std::swap(m_IDAT, png.m_IDAT);
+    std::swap(m_PLTE, png.m_PLTE);
+    std::swap(m_tRNS, png.m_tRNS);
+    std::swap(m_IEND, png.m_IEND);
+    std::swap(m_options, png.m_options);
+}
+
+
 /**
  * @brief Construct a new PNG::PNG object
  * 
  * @param path the file path of the png file to read
+ * @param options the decoding options (decoded region and scale)
  */
-PNG::PNG(const std::string &path)
+PNG::PNG(const std::string &path, const DecodeOptions &options)
+    : PNG(ChunkWalker(path), path, options)
 {
-    int s_width(0), s_height(0), pixelsBufferLen(0), ppuX(0), ppuY(0);
-    uint8_t bitDepth(0), colorMode(0), colorChannel(0), unitSpecifier(0);
+}
 
-    // we read informations in the specified file
-    uint8_t *tmp = PNG::readPixels(path, s_width, s_height, bitDepth, colorMode, colorChannel, pixelsBufferLen, ppuX, ppuY, unitSpecifier);
 
-    // nom we copy the parsed pixelBuffer in our own buffer;
-    m_pixelBuffer = new uint8_t[pixelsBufferLen];
-    memcpy(m_pixelBuffer, tmp, pixelsBufferLen);
+/**
+ * @brief decoding an in memory png file, without any temporary file
+ * @note the sources are C++17, without std::span : the datas are given as a pointer and a length, or as a vector.
+ * 
+ * @param datas the png file datas, from the signature
+ * @param len the png file datas length
+ * @param options the decoding options (decoded region and scale)
+ * @return PNG the decoded png
+ * 
+ * @exception std::invalid_argument if the decoded region is not inside the png, if the scale is not 1, 2, 4 or 8 or if native order samples are asked
+ * @exception std::runtime_error if the datas are not a valid png, or an unmanaged one
+ */
+PNG PNG::decode(const uint8_t *datas, std::size_t len, const DecodeOptions &options)
+{
+    return PNG(ChunkWalker(datas, len), "memory buffer", options);
+}
 
-    m_signature = new uint8_t[8]; // we assign the PNG signature
-    m_signature[0] = 0x89;
-    m_signature[1] = 0x50;
-    m_signature[2] = 0x4E;
-    m_signature[3] = 0x47;
-    m_signature[4] = 0x0D;
-    m_signature[5] = 0x0A;
-    m_signature[6] = 0x1A;
-    m_signature[7] = 0x0A;
 
-    // setting up all the png Chunks, calling constructors
-    m_IHDR = new IHDR_CHUNK(s_width, s_height, bitDepth, colorMode);
-    m_pHYs = new PHYS_CHUNK(ppuX, ppuY, unitSpecifier);
-    m_IDAT = new IDAT_CHUNK(m_pixelBuffer, s_width, s_height, colorChannel);
+/**
+ * @brief decoding an in memory png file, without any temporary file
+ * 
+ * @param datas the png file datas, from the signature
+ * @param options the decoding options (decoded region and scale)
+ * @return PNG the decoded png
+ * 
+ * @exception std::invalid_argument if the decoded region is not inside the png, if the scale is not 1, 2, 4 or 8 or if native order samples are asked
+ * @exception std::runtime_error if the datas are not a valid png, or an unmanaged one
+ */
+PNG PNG::decode(const std::vector<uint8_t> &datas, const DecodeOptions &options)
+{
+    return decode(datas.data(), datas.size(), options);
+}
+
+
+/**
+ * @brief Construct a new PNG::PNG object, from the chunks of a png file
+ * 
+ * @param chunks the walked chunks of the png file (mapped file or memory buffer)
+ * @param source the png source name (file path), for the error messages
+ * @param options the decoding options (decoded region and scale)
+ */
+PNG::PNG(const ChunkWalker &chunks, const std::string &source, const DecodeOptions &options)
+{
+    if (options.nativeOrder)
+        throw std::invalid_argument("PNG - The pixels of a PNG object are in png byte order, use PNG::decode_into for native order samples");
+
+    // we read informations in the png chunks, the pixels are decoded directly in our own buffer
+    Info info = read_info(chunks, source);
+    Info decoded = decoded_info(info, options);
+    m_pixelBuffer.reset(new uint8_t[decoded.row_bytes() * decoded.height]);
+    read_pixels(chunks, info, options, source, m_pixelBuffer.get(), decoded.row_bytes());
+
+    // setting up all the png Chunks, calling constructors, the IDAT chunk is only encoded when saving
+    m_IHDR = new IHDR_CHUNK(decoded.width, decoded.height, decoded.bitDepth, decoded.colorMode);
+    m_pHYs = new PHYS_CHUNK(decoded.ppuX, decoded.ppuY, decoded.unitSpecifier);
     m_IEND = new IEND_CHUNK();
+}
+
+
+/**
+ * @brief decoding a png file directly in a caller's buffer, without intermediate copy nor encoding
+ * @details each scanline is inflated and unfiltered in place at its row of the buffer, the rows can be padded
+ * (aligned rows of a frame pool, GL upload buffer...).
+ * 
+ * @param path the file path of the png file to read
+ * @param buffer the destination of the pixels, at least stride * (height - 1) + width * colorChannel bytes
+ * @param bufferLen the length of the destination buffer
+ * @param stride the distance in bytes between two rows of the buffer, 0 for packed rows
+ * @param options the decoding options (decoded region and scale)
+ * @return Info the decoded pixels informations (region size, bit depth, color mode...)
+ * 
+ * @exception std::invalid_argument if the stride is smaller than a row, if the buffer is too small, if the region or the scale are invalid
+ * or if native order samples are asked for a png which is not a 16 bits png
+ * @exception std::runtime_error if the file is not a valid png, or an unmanaged one
+ */
+PNG::Info PNG::decode_into(const std::string &path, uint8_t *buffer, std::size_t bufferLen, std::size_t stride, const DecodeOptions &options)
+{
+    return decode_into(ChunkWalker(path), path, buffer, bufferLen, stride, options);
+}
+
+
+/**
+ * @brief decoding an in memory png file directly in a caller's buffer, without intermediate copy nor encoding
+ * 
+ * @param datas the png file datas, from the signature
+ * @param len the png file datas length
+ * @param buffer the destination of the pixels, at least stride * (height - 1) + width * colorChannel bytes
+ * @param bufferLen the length of the destination buffer
+ * @param stride the distance in bytes between two rows of the buffer, 0 for packed rows
+ * @param options the decoding options (decoded region and scale)
+ * @return Info the decoded pixels informations (region size, bit depth, color mode...)
+ * 
+ * @exception std::invalid_argument if the stride is smaller than a row, if the buffer is too small, if the region or the scale are invalid
+ * or if native order samples are asked for a png which is not a 16 bits png
+ * @exception std::runtime_error if the datas are not a valid png, or an unmanaged one
+ */
+PNG::Info PNG::decode_into(const uint8_t *datas, std::size_t len, uint8_t *buffer, std::size_t bufferLen, std::size_t stride, const DecodeOptions &options)
+{
+    return decode_into(ChunkWalker(datas, len), "memory buffer", buffer, bufferLen, stride, options);
+}
+
+
+/**
+ * @brief decoding a 16 bits png file in a caller's image, as samples in the cpu byte order
+ * @details the samples are byte swapped while the rows are copied, the image can then be given to the PixelsManager methods.
+ * 
+ * @param path the file path of the png file to read
+ * @param image the destination image, of the decoded size (region and scale) and with the png samples per pixel
+ * @param options the decoding options (decoded region and scale), DecodeOptions::nativeOrder is set
+ * @return Info the decoded pixels informations (region size, bit depth, color mode...)
+ * 
+ * @exception std::invalid_argument if the png is not a 16 bits png, if the image doesn't have the decoded size or if the region or the scale are invalid
+ * @exception std::runtime_error if the file is not a valid png, or an unmanaged one
+ */
+PNG::Info PNG::decode_into(const std::string &path, ImageView<uint16_t> image, const DecodeOptions &options)
+{
+    return decode_into(ChunkWalker(path), path, image, options);
+}
+
+
+/**
+ * @brief decoding an in memory 16 bits png file in a caller's image, as samples in the cpu byte order
+ * 
+ * @param datas the png file datas, from the signature
+ * @param len the png file datas length
+ * @param image the destination image, of the decoded size (region and scale) and with the png samples per pixel
+ * @param options the decoding options (decoded region and scale), DecodeOptions::nativeOrder is set
+ * @return Info the decoded pixels informations (region size, bit depth, color mode...)
+ * 
+ * @exception std::invalid_argument if the png is not a 16 bits png, if the image doesn't have the decoded size or if the region or the scale are invalid
+ * @exception std::runtime_error if the datas are not a valid png, or an unmanaged one
+ */
+PNG::Info PNG::decode_into(const uint8_t *datas, std::size_t len, ImageView<uint16_t> image, const DecodeOptions &options)
+{
+    return decode_into(ChunkWalker(datas, len), "memory buffer", image, options);
+}
+
+
+/**
+ * @brief decoding the chunks of a 16 bits png file in a caller's image, after checking the image size
+ * 
+ * @param chunks the walked chunks of the png file
+ * @param source the png source name (file path), for the error messages
+ * @param image the destination image
+ * @param options the decoding options (decoded region and scale)
+ * @return Info the decoded pixels informations
+ * 
+ * @exception std::invalid_argument if the png is not a 16 bits png, if the image doesn't have the decoded size or if the region or the scale are invalid
+ * @exception std::runtime_error if the png is not valid, or an unmanaged one
+ */
+PNG::Info PNG::decode_into(const ChunkWalker &chunks, const std::string &source, ImageView<uint16_t> image, const DecodeOptions &options)
+{
+    Info decoded = decoded_info(read_info(chunks, source), options);
+    if (decoded.bitDepth != 16)
+        throw std::invalid_argument("PNG::decode_into() - Native order samples need a 16 bits png, \"" + source + "\" is not");
+    if (decoded.width != image.width || decoded.height != image.height || decoded.colorChannel != 2 * image.channels)
+        throw std::invalid_argument("PNG::decode_into() - The image doesn't have the decoded size of \"" + source + "\"");
+
+    DecodeOptions nativeOptions = options;
+    nativeOptions.nativeOrder = true;
+    return decode_into(chunks, source, reinterpret_cast<uint8_t *>(image.data), image.size() * 2, image.stride * 2, nativeOptions);
+}
+
+
+/**
+ * @brief decoding the chunks of a png file in a caller's buffer, after checking the buffer layout
+ * 
+ * @param chunks the walked chunks of the png file
+ * @param source the png source name (file path), for the error messages
+ * @param buffer the destination of the pixels
+ * @param bufferLen the length of the destination buffer
+ * @param stride the distance in bytes between two rows of the buffer, 0 for packed rows
+ * @param options the decoding options (decoded region and scale)
+ * @return Info the decoded pixels informations
+ * 
+ * @exception std::invalid_argument if the stride is smaller than a row, if the buffer is too small, if the region or the scale are invalid
+ * or if native order samples are asked for a png which is not a 16 bits png
+ * @exception std::runtime_error if the png is not valid, or an unmanaged one
+ */
+PNG::Info PNG::decode_into(const ChunkWalker &chunks, const std::string &source, uint8_t *buffer, std::size_t bufferLen, std::size_t stride, const DecodeOptions &options)
+{
+    Info info = read_info(chunks, source);
+    Info decoded = decoded_info(info, options);
+    if (options.nativeOrder && info.bitDepth != 16)
+        throw std::invalid_argument("PNG::decode_into() - Native order samples need a 16 bits png, \"" + source + "\" is not");
+
+    std::size_t rowBytes = decoded.row_bytes();
+    if (stride == 0)
+        stride = rowBytes;
+    if (stride < rowBytes)
+        throw std::invalid_argument("PNG::decode_into() - The stride is smaller than a row of \"" + source + "\"");
+    if (decoded.height > 0 && (buffer == nullptr || bufferLen < stride * (decoded.height - 1) + rowBytes))
+        throw std::invalid_argument("PNG::decode_into() - The buffer is too small for \"" + source + "\"");
+
+    read_pixels(chunks, info, options, source, buffer, stride);
+    return decoded;
+}
+
+
+/**
+ * @brief reading the informations of a png file (IHDR chunk), without decoding its pixels
+ * @details only the signature and the IHDR chunk are read (33 bytes), the following chunks headers are read
+ * until the first IDAT chunk if the pHYs chunk is searched.
+ * 
+ * @param path the file path of the png file to probe
+ * @param physical true for searching the pHYs chunk, and reading its values
+ * @return Info the png informations, IHDR fields as written in the file, colorChannel is 0 for packed pixels (palette, less than 8 bits) and unmanaged color modes
+ * 
+ * @exception std::runtime_error if cannot open the file as specified path
+ * @exception std::runtime_error if the file is not a valid png (signature, truncated or corrupted IHDR chunk)
+ */
+PNG::Info PNG::probe(const std::string &path, bool physical)
+{
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr)
+        throw std::runtime_error("Enable to open file at specified path : " + path);
+
+    Reader read = [file](std::size_t offset, uint8_t *out, std::size_t len) -> std::size_t
+    {
+        if (std::fseek(file, static_cast<long>(offset), SEEK_SET) != 0)
+            return 0;
+        return std::fread(out, 1, len, file);
+    };
+
+    try
+    {
+        Info info = probe(read, path, physical);
+        std::fclose(file);
+        return info;
+    }
+    catch (const std::exception &)
+    {
+        std::fclose(file);
+        throw;
+    }
+}
+
+
+/**
+ * @brief reading the informations of an in memory png file (IHDR chunk), without decoding its pixels
+ * 
+ * @param datas the png file datas, from the signature
+ * @param len the png file datas length
+ * @param physical true for searching the pHYs chunk, and reading its values
+ * @return Info the png informations, IHDR fields as written in the file, colorChannel is 0 for packed pixels (palette, less than 8 bits) and unmanaged color modes
+ * 
+ * @exception std::runtime_error if the datas are not a valid png (signature, truncated or corrupted IHDR chunk)
+ */
+PNG::Info PNG::probe(const uint8_t *datas, std::size_t len, bool physical)
+{
+    Reader read = [datas, len](std::size_t offset, uint8_t *out, std::size_t count) -> std::size_t
+    {
+        if (offset >= len)
+            return 0;
+        count = std::min(count, len - offset);
+        std::memcpy(out, datas + offset, count);
+        return count;
+    };
+
+    return probe(read, "memory buffer", physical);
+}
+
+
+/**
+ * @brief reading the signature, the IHDR chunk and optionally the pHYs chunk of a png through a reader
+ * 
+ * @param read the reader, copying up to len bytes from offset and returning the number of copied bytes
+ * @param source the png source name (file path), for the error messages
+ * @param physical true for searching the pHYs chunk, and reading its values
+ * @return Info the png informations
+ * 
+ * @exception std::runtime_error if the png is not valid (signature, truncated or corrupted IHDR chunk)
+ */
+PNG::Info PNG::probe(const Reader &read, const std::string &source, bool physical)
+{
+    // the signature then the IHDR chunk, always the first one : length, type, 13 bytes of datas and crc32
+    uint8_t header[33];
+    if (read(0, header, 33) != 33 || std::memcmp(header, signature, 8) != 0)
+        throw std::runtime_error("Invalid png signature in \"" + source + "\"");
+    if (Utilities::read_be32(header + 8) != 13 || std::memcmp(header + 12, "IHDR", 4) != 0
+        || CRC32::update(0, header + 12, 17) != Utilities::read_be32(header + 29))
+        throw std::runtime_error("Missing or invalid IHDR chunk in \"" + source + "\"");
+
+    Info info;
+    IHDR_CHUNK::read_datas(header + 16, info.width, info.height, info.bitDepth, info.colorMode, info.interlacing);
+    info.colorChannel = get_colorChannels(info.bitDepth, info.colorMode);
+
+    // the pHYs chunk must be before the first IDAT chunk, only the chunks headers are read
+    std::size_t offset = 33;
+    uint8_t chunk[8];
+    while (physical && read(offset, chunk, 8) == 8)
+    {
+        uint32_t length = Utilities::read_be32(chunk);
+        if (std::memcmp(chunk + 4, "IDAT", 4) == 0 || std::memcmp(chunk + 4, "IEND", 4) == 0)
+            break;
 
-    delete[] tmp;
+        uint8_t datas[9];
+        if (std::memcmp(chunk + 4, "pHYs", 4) == 0 && length == 9 && read(offset + 8, datas, 9) == 9)
+        {
+            info.physical = true;
+            info.ppuX = Utilities::read_be32(datas);
+            info.ppuY = Utilities::read_be32(datas + 4);
+            info.unitSpecifier = datas[8];
+            break;
+        }
+        offset += 12 + static_cast<std::size_t>(length);
+    }
+
+    return info;
 }
 
 
@@ -188,10 +467,90 @@ PNG::PNG(const std::string &path)
  */
 PNG::~PNG()
 {
-    delete[] m_signature; delete[] m_pixelBuffer;
-    delete m_IHDR;  delete m_pHYs;  delete m_IDAT;  delete m_IEND;
+    delete m_IHDR;  delete m_pHYs;  delete m_IEND;
+}
+
+/**
+ * @brief writing the actual png in a specific directory path, encoded with specific options
+ * 
+ * @param path the path to store the png file
+ * @param options the encoding options (zlib parameters and filter selection strategy)
+ * @see EncodeOptions
+ * 
+ * @exception std::invalid_argument case Invalid encoding options
+ * @exception std::runtime_error if cannot create file as specified path 
+ */
+void PNG::save(const std::string &path, const EncodeOptions &options)
+{
+    // the scanlines are encoded again, the next saves will keep these options
+    PNG encoded(*this);
+    encoded.m_options = options;
+    encoded.m_IDAT.reset();
+    encoded.m_PLTE.reset();
+    encoded.m_tRNS.reset();
+    encoded.encode();
+    swap(encoded);
+
+    save(path);
+}
+
+
+/**
+ * @brief encoding the scanlines in the IDAT chunk, if not already done since the last pixels change
+ * @see PNG::encode_palette
+ * 
+ * @exception std::invalid_argument case Invalid encoding options
+ */
+void PNG::encode()
+{
+    if (m_IDAT != nullptr)
+        return;
+
+    if (!m_options.palette || !encode_palette())
+        m_IDAT = std::make_shared<IDAT_CHUNK>(m_pixelBuffer.get(), get_width(), get_height(), get_colorChannels(get_bitDepth(), get_colorMode()), m_options);
+}
+
+
+/**
+ * @brief encoding the scanlines as palette indices, with the PLTE and tRNS chunks
+ * @details only 8 bits RGB and RGBA images are encoded with a palette, when they have at most 256 colors or when
+ * the quantization is enabled. The indices are packed on the smallest bit depth, and the scanlines are not filtered
+ * since filters hardly ever help indices.
+ * @see Palette
+ * 
+ * @return true if the scanlines are encoded with a palette, false if the image must be encoded as it is
+ * 
+ * @exception std::invalid_argument case Invalid encoding options
+ */
+bool PNG::encode_palette()
+{
+    if (get_bitDepth() != 8 || (get_colorMode() != 2 && get_colorMode() != 6))
+        return false;
+
+    Palette palette(m_pixelBuffer.get(), get_width() * get_height(), get_colorChannels(get_bitDepth(), get_colorMode()), m_options.quantize, m_options.quantizeIterations);
+    if (!palette.is_valid())
+        return false;
+
+    uint8_t colors[3 * Palette::maxEntries], alphas[Palette::maxEntries];
+    palette.get_colors(colors);
+    palette.get_alphas(alphas);
+    std::shared_ptr<PLTE_CHUNK> plte = std::make_shared<PLTE_CHUNK>(colors, palette.get_entries());
+    std::shared_ptr<TRNS_CHUNK> trns = (palette.get_transparent_entries() > 0) ? std::make_shared<TRNS_CHUNK>(alphas, palette.get_transparent_entries()) : nullptr;
+
+    // the lines of packed indices are encoded as an image of one byte per pixel
+    uint8_t bitDepth = plte->get_bitDepth();
+    std::vector<uint8_t> indices = palette.index_pixels(m_pixelBuffer.get(), get_width(), get_height(), bitDepth);
+    EncodeOptions options = m_options;
+    options.filtering.selection = Filters::Selection::FIXED;
+    options.filtering.fixedFilter = 0;
+    m_IDAT = std::make_shared<IDAT_CHUNK>(indices.data(), (get_width() * bitDepth + 7) / 8, get_height(), 1, options);
+
+    m_PLTE = plte;
+    m_tRNS = trns;
+    return true;
 }
 
+
 /**
  * @brief writing the actual png in a specific directory path
  * 
@@ -205,21 +564,64 @@ PNG::~PNG()
  */
 void PNG::save(const std::string &path)
 {
-    std::ofstream outputStream(path.c_str(), std::ios::out | std::ios::binary); // Opening the output file stream
+    using namespace std::literals;
 
-    if (outputStream.is_open())
+    encode(); // the file is only created once the scanlines are encoded
+    try
+    {
+        FileSink sink(path); // Opening the output file
+        save(sink);
+        sink.close();
+    }
+    catch (const std::runtime_error &exception)
     {
-        Utilities::stream_write(m_signature, 8, outputStream);
-        m_IHDR->save(outputStream); // calling each chunk writing method
-        if (m_pHYs->get_state()) m_pHYs->save(outputStream); // cause pHYs is an auxiliary chunk, we write it only if its present
-        m_IDAT->save(outputStream);
-        m_IEND->save(outputStream);
+        throw std::runtime_error("PNG::save() - "s + exception.what());
     }
+}
+
+
+/**
+ * @brief writing the actual png in an output sink (file, memory, user callback)
+ * 
+ * @param sink the output sink
+ * @see IHDR_CHUNK::save
+ * @see PHYS_CHUNK::save
+ * @see PLTE_CHUNK::save
+ * @see TRNS_CHUNK::save
+ * @see IDAT_CHUNK::save
+ * @see IEND_CHUNK::save
+ * 
+ * @exception std::runtime_error if the sink cannot write the datas
+ */
+void PNG::save(OutputSink &sink)
+{
+    encode();
+    sink.write(signature, 8);
+    if (m_PLTE != nullptr) // palette encoding, the header gives the indices bit depth
+        IHDR_CHUNK(get_width(), get_height(), m_PLTE->get_bitDepth(), 3).save(sink);
     else
-        throw std::runtime_error("PNG::save() - Enable to create file at specified path : " + path);
+        m_IHDR->save(sink); // calling each chunk writing method
+    if (m_pHYs->get_state()) m_pHYs->save(sink); // cause pHYs is an auxiliary chunk, we write it only if its present
+    if (m_PLTE != nullptr) m_PLTE->save(sink);
+    if (m_tRNS != nullptr) m_tRNS->save(sink);
+    m_IDAT->save(sink);
+    m_IEND->save(sink);
+    sink.flush();
+}
+
 
-    outputStream.clear();
-    outputStream.close();
+/**
+ * @brief encoding the actual png in memory, as a png file
+ * 
+ * @param output the vector in which the png file bytes are appended
+ */
+void PNG::encode_to(std::vector<uint8_t> &output)
+{
+    encode();
+    std::size_t paletteLength = (m_PLTE != nullptr) ? 12 + m_PLTE->m_length : 0, transparencyLength = (m_tRNS != nullptr) ? 12 + m_tRNS->m_length : 0;
+    output.reserve(output.size() + 8 + 25 + 21 + paletteLength + transparencyLength + 12 + m_IDAT->m_length + 12); // signature, IHDR, pHYs, PLTE, tRNS, IDAT and IEND chunks
+    MemorySink sink(output);
+    save(sink);
 }
 
 
@@ -277,249 +679,303 @@ void PNG::glScreenshot(const std::string &png_dir, int x, int y, int width, int
 
 
 /**
- * @brief method for parsing and extracting informations from a specified PNG file
- * @warning only managed are grayscale and rgb images, no indexed colors
+ * @brief method for parsing informations from the chunks of a png file (IHDR and pHYs)
+ * @details palette pngs and grayscale pngs of less than 8 bits are expanded when decoded, the returned informations
+ * are the ones of the expanded pixels : 8 bits grayscale, RGB or RGBA (palette with a tRNS chunk).
+ * @see PixelExpander
  * 
- * @param path the png file path to read/parse
- * @param s_width  the png width information 
- * @param s_height the png height information
- * @param bitDepth the png bit depth information
- * @param colorMode the png color mode information, only managed are 0(grayscale), 2(RGB true color) and 6(RGBA)
- * @param colorChannel the png color Channels according to the colorMode (colorMode->colorChannel)  0 -> 1, 2 -> 3, 6 -> 4
- * @param pixelsBufferLen the length of the pixels Buffer of the png
- * @param ppuX the physical pixel dimension (on x axis) of the png
- * @param ppuY the physical pixel value (on y axis) of the png
- * @param unitSpecifier the phisical pixel dimension unit of the png
- * @return either nullptr if an error occurred or the pixels buffer, type uint8_t
+ * @param chunks the walked chunks of the png file
+ * @param source the png source name (file path), for the error messages
+ * @return Info the png informations
  * 
- * @exception std::runtime_error if cannot png file as specified path
- * @exception std::runtime_error if bit depth is different than 8 or 16
- * @exception std::runtime_error if color mode is diffrent than 0(grayscale), 1(grayscale with alpha), 2(RGB), 4(RGBA)
+ * @exception std::runtime_error if the file is not a valid png (signature, truncated chunk, missing IHDR)
+ * @exception std::runtime_error if the bit depth is not allowed for the color mode
+ * @exception std::runtime_error if color mode is diffrent than 0(grayscale), 3(palette), 4(grayscale with alpha), 2(RGB), 6(RGBA)
  */
-uint8_t *PNG::readPixels(const std::string &path, int &s_width, int &s_height, uint8_t &bitDepth, uint8_t &colorMode, uint8_t &colorChannel, int &pixelsBufferLen, int &ppuX, int &ppuY, uint8_t &unitSpecifier)
+PNG::Info PNG::read_info(const ChunkWalker &chunks, const std::string &source)
 {
-    /*for a dynamic parsing purpose(only reading criticals chunk and pHYs), we need to know the exact position of each chunk, characterized
-      here by the chunk type, stored as "word" in a string*/
+    // the chunks list has been walked once, each chunk is directly accessed from its record
+    const ChunkWalker::Chunk *header = chunks.find("IHDR");
+    if (header == nullptr || header->length != 13)
+        throw std::runtime_error("Missing or invalid IHDR chunk in \"" + source + "\"");
 
-    std::ifstream input(path, std::ios::in | std::ios::binary); // we start opening the png stream, in binary modes
-    if (input.is_open())                         // if opening is okk
-    {
-        std::string word = "IHDR"; // we start by placing the cursor infront of the header chunk and skip the chunk type ("IHDR")
-        input.seekg(Utilities::f_strchr(input, word, 0) + 4);
-
-        // we read the png width and store it
-        uint8_t *widthArrayPtr = new uint8_t[4];
-        for (int i = 0; i < 4; i++)
-            input >> std::noskipws >> widthArrayPtr[i];
-        s_width = Utilities::uint8_to_int(widthArrayPtr);
-        delete[] widthArrayPtr;
-
-        // same with the png height
-        uint8_t *heightArrayPtr = new uint8_t[4];
-        for (int i = 0; i < 4; i++)
-            input >> std::noskipws >> heightArrayPtr[i];
-        s_height = Utilities::uint8_to_int(heightArrayPtr);
-        delete[] heightArrayPtr;
-
-        // same with the bitDepth annd color mode
-        input >> std::noskipws >> bitDepth;
-        if (bitDepth != 0x8 && bitDepth != 0x10)
-            throw(std::runtime_error("Invalid bit depth, must be 8 or 16"));
-
-        int channel_size = bitDepth / 8; // represents in how many bytes values are stored for each channel.
-        input >> std::noskipws >> colorMode;
-        // according to the parsed color mode value, we set the color channel for the output pixelsBuffer.
-        if (colorMode == 0)
-            pixelsBufferLen = s_height * s_width * (colorChannel = 1*channel_size); // for grayscale images
-        else if (colorMode == 4)
-            pixelsBufferLen = s_height * s_width * (colorChannel = 2*channel_size); // for grayscale alpha images
-        else if (colorMode == 2)
-            pixelsBufferLen = s_height * s_width * (colorChannel = 3*channel_size); // for RGB true color images
-        else if (colorMode == 6)
-            pixelsBufferLen = s_height * s_width * (colorChannel = 4*channel_size); // for RGBA images
-        else
-            throw std::runtime_error("Only Color modes 0(grayscale), 1(grayscale with alpha), 2(RGB true color) and 6(RGBA) are managed");
-
-        // we place the cursor before the pHYs chunk (chunk typre = "pHYs")
-        word = "pHYs";
-        input.seekg(0, std::ios::beg);
-        int is_chunk(Utilities::f_strchr(input, word, 0));
-        // pHYs chunk is not a critical chunk, then we need to test if it appear in the parsed png or not
-        if (is_chunk == -1)
-            ppuX = ppuY = unitSpecifier = 0;
-        else
-        {
-            input.seekg(is_chunk, std::ios::beg);
-            input.seekg(4, std::ios::cur); // we skip the word "pHYs"
-
-            uint8_t *ppuXArrayPtr = new uint8_t[4]; // we read the physical pixel dimension
-            for (int i = 0; i < 4; i++)
-                input >> std::noskipws >> ppuXArrayPtr[i];     // reading
-            ppuX = Utilities::uint8_to_int(ppuXArrayPtr); // storing
-            delete[] ppuXArrayPtr;
-
-            uint8_t *ppuYArrayPtr = new uint8_t[4]; // we read the physical pixel dimension
-            for (int i = 0; i < 4; i++)
-                input >> std::noskipws >> ppuYArrayPtr[i];     // reading
-            ppuY = Utilities::uint8_to_int(ppuYArrayPtr); // storing
-            delete[] ppuYArrayPtr;
-
-            input >> std::noskipws >> unitSpecifier; // we store the unit specifier
-        }
+    // we read the png width, height, bitDepth and color mode
+    Info info;
+    IHDR_CHUNK::read_datas(header->data, info.width, info.height, info.bitDepth, info.colorMode, info.interlacing);
 
-        // IDAT chunks parsing, can be single or multiples
-        word = "IDAT";
-        input.seekg(0, std::ios::beg);
-        const std::vector<int> &positions(Utilities::f_strchr(input, word)); // getting all the IDAT chunks positions in a vector
+    if (info.colorMode != 0 && info.colorMode != 2 && info.colorMode != 3 && info.colorMode != 4 && info.colorMode != 6)
+        throw std::runtime_error("Only Color modes 0(grayscale), 3(palette), 4(grayscale with alpha), 2(RGB true color) and 6(RGBA) are managed");
 
-        int deflatedLength(0);
-        int *deflatedLengths = new int[positions.size()]; // array which will containt the IDAT chunks deflated datas lengths
-        for (std::size_t i = 0; i < positions.size(); i++)        // reading and storing each IDAT chunk length
-        {
-            input.seekg(positions[i], std::ios::beg);
-            input.seekg(-4, std::ios::cur);
-
-            // we read and store the actual chunk length
-            uint8_t *deflatedLengthPtr = new uint8_t[4];
-            for (int j = 0; j < 4; j++)
-                input >> std::noskipws >> deflatedLengthPtr[j];                   // reading
-            deflatedLengths[i] = Utilities::uint8_to_int(deflatedLengthPtr); // storing
-            delete[] deflatedLengthPtr;
-            deflatedLength += deflatedLengths[i];
-        }
-
-        // then now we have all the lengths of each IDAT chunks, next step is fo read deflated datas
-        int k(0);
-        uint8_t *deflatedBuffer = new uint8_t[deflatedLength]; // mem allocation for the deflated buffer
-        for (int i = 0; i < positions.size(); i++)
-        {
-            input.seekg(positions[i], std::ios::beg); // positioning on each chunk start
-            input.seekg(4, std::ios::cur);            // skipping the chunk type, ("IDAT" word)
+    // 1, 2 and 4 bits are only allowed for grayscale and palette, 16 bits for all but palette
+    bool subByte = (info.bitDepth == 1 || info.bitDepth == 2 || info.bitDepth == 4);
+    if (!(info.bitDepth == 8 || (info.bitDepth == 16 && info.colorMode != 3) || (subByte && (info.colorMode == 0 || info.colorMode == 3))))
+        throw(std::runtime_error("Invalid bit depth for the color mode"));
 
-            for (int j = 0; j < deflatedLengths[i]; j++) // copying the deflated data of each chunk in the buffer
-            {
-                input >> std::noskipws >> deflatedBuffer[k];
-                k++;
-            }
-        }
+    // packed pixels are expanded to 8 bits samples, palette indices to RGB or RGBA colors
+    if (PixelExpander::is_packed(info.bitDepth, info.colorMode))
+    {
+        info.colorMode = (info.colorMode == 0) ? 0 : (chunks.find("tRNS") != nullptr) ? 6 : 2;
+        info.bitDepth = 8;
+    }
 
-        // now we'll inflate(decompress) the deflated pixels and store it into a scanlines buffer
-        uint8_t *scanlines = new uint8_t[pixelsBufferLen + s_height];
-        unsigned long scanlinesLength(pixelsBufferLen + s_height);
-        uncompress(scanlines, &scanlinesLength, deflatedBuffer, deflatedLength); // decompressing...
+    // according to the color mode value, we set the color channel for the output pixelsBuffer.
+    info.colorChannel = get_colorChannels(info.bitDepth, info.colorMode);
 
-        // next step is to unfilter each scanline and return the raw buffer
-        uint8_t *unfilteredLine[s_height];
-        uint8_t *rawBuffer = new uint8_t[pixelsBufferLen]; // the raw buffer memory allocation
+    // pHYs chunk is not a critical chunk, then we need to test if it appear in the parsed png or not
+    const ChunkWalker::Chunk *physical = chunks.find("pHYs");
+    if (physical != nullptr && physical->length == 9)
+    {
+        info.physical = true;
+        info.ppuX = Utilities::read_be32(physical->data); // we read the physical pixel dimensions
+        info.ppuY = Utilities::read_be32(physical->data + 4);
+        info.unitSpecifier = physical->data[8]; // we store the unit specifier
+    }
 
-        for (int i = 1; i <= s_height; i++)
-            memcpy(rawBuffer + (i - 1) * (s_width * colorChannel),                                                                                  // the destination
-                   (unfilteredLine[i - 1] = unfilter_line(scanlines + 1 + (i - 1) * (s_width * colorChannel + 1), s_width * colorChannel, // the source which is the result of the unfiltering each scanline
-                                                          scanlines[(i - 1) * (s_width * colorChannel + 1)], ((i - 1) == 0) ? false : true,
-                                                          ((i - 1) == 0) ? nullptr : rawBuffer + (i - 2) * (s_width * colorChannel), colorChannel)),
-                s_width * colorChannel                                                                                                           // the copying length (which is the unfiltered line length)
-            );
+    return info;
+}
 
-        input.clear();                                     // clearing the input stream
-        delete[] deflatedBuffer; delete[] scanlines; delete[] deflatedLengths; // freeing allocated memory...
-        for (int i = 0; i < s_height; i++)  delete[] unfilteredLine[i];
 
-        return rawBuffer; // returning the pixelsBuffer
-    }
-    else
-        throw std::runtime_error("Enable to open the file \"" + path + "\"" );
+/**
+ * @brief get the informations of the decoded pixels, according to the decoding options
+ * 
+ * @param info the png informations, read by PNG::read_info
+ * @param options the decoding options (decoded region and scale)
+ * @return Info the decoded pixels informations, with the reduced region size
+ * 
+ * @exception std::invalid_argument if the region is not inside the png, or if the scale is not 1, 2, 4 or 8
+ */
+PNG::Info PNG::decoded_info(const Info &info, const DecodeOptions &options)
+{
+    const DecodeOptions::Region &region = options.region;
+    if (region.x < 0 || region.y < 0 || region.width < 0 || region.height < 0
+        || region.x + region.width > info.width || region.y + region.height > info.height)
+        throw std::invalid_argument("PNG - The decoded region is not inside the png");
+    if (options.scale != 1 && options.scale != 2 && options.scale != 4 && options.scale != 8)
+        throw std::invalid_argument("PNG - The decoding scale must be 1, 2, 4 or 8");
+
+    Info decoded = info;
+    decoded.width = (region.width == 0) ? info.width - region.x : region.width;
+    decoded.height = (region.height == 0) ? info.height - region.y : region.height;
+    decoded.width = (decoded.width + options.scale - 1) / options.scale;
+    decoded.height = (decoded.height + options.scale - 1) / options.scale;
+    return decoded;
 }
 
 
 /**
- * @brief unfiltering line method
- * @details png format has many filtering options for improving the compression(deflate)
- * then after decompression(inflate), datas needs to be unfiltered, according to the specified filter method
- * @note filtering and unfiltering methods are applied one each line.
- *
- * @param line_in the input line to unfilter
- * @param lineLength the input line length
- * @param filterMode the filter mode of the actual line ( 0 = none, 1 = Sub, 2 = Up, 3 = Average, 4 = Paeth)
- * @param is_prev_line if the actual line have a predecessor line
- * @param unfiltered_prev_line the predecessor line (already unfiltered)
- * @param colorChannel the number of color channel of the input line
- * @return uint8_t* unfiltered line
- *
- * @exception std::bad_alloc case unfiltered line memory allocation failed
- * @exception std::invalid_argument case Invalid filter mode
+ * @brief method for extracting the pixels from the IDAT chunks of a png file
+ * @details IDAT datas are inflated and unfiltered as a stream, line by line. The rows of the region are unfiltered directly
+ * in the output buffer if they are complete, else in a scratch line from which the region columns are copied.
+ * Rows above the region only go through the scratch lines, and the inflate stream is dropped after the last row of the region.
+ * With a scale, the region samples of each line are summed in a single row of accumulators, emitted as averages every scale lines.
+ * Adam7 interlaced passes are unfiltered one after the other and scattered in the output buffer for a whole image, else in a full
+ * temporary image from which the region rows are stored. With a scale, the decoding stops after the pass filling the grid of the
+ * reduced image (Adam7::get_gridPass) : only the grid pixels are scattered, in an image reduced by the scale, from which each
+ * block takes its grid pixel. DecodeOptions::onPass is called after each pass and can stop the decoding, the missing pixels
+ * are then replicated from the decoded ones.
+ * With DecodeOptions::nativeOrder, 16 bits samples are byte swapped (SIMD) when their row is copied from the scratch lines.
+ * @see ChunkWalker
+ * @see ScanlineDecoder
+ * 
+ * @param chunks the walked chunks of the png file
+ * @param info the png informations, read by PNG::read_info
+ * @param options the decoding options (decoded region and scale)
+ * @param source the png source name (file path), for the error messages
+ * @param buffer the destination of the pixels, at least stride * (height - 1) + row_bytes() bytes of the decoded region
+ * @param stride the distance in bytes between two rows of the buffer, at least row_bytes() of the decoded region
+ * 
+ * @exception std::runtime_error if the IDAT chunk is missing or if its datas are corrupted
  */
-uint8_t *PNG::unfilter_line(const uint8_t *line_in, int lineLength, uint8_t filterMode, bool is_prev_line, const uint8_t *unfiltered_prev_line, uint8_t colorChannel)
+void PNG::read_pixels(const ChunkWalker &chunks, const Info &info, const DecodeOptions &options, const std::string &source, uint8_t *buffer, std::size_t stride)
 {
-    int i(0);
-    uint8_t *line_out = new uint8_t[lineLength]; // unfiltered output buffer
-    if (!line_out)
-        throw std::bad_alloc();
-
-    switch (filterMode)
+    // IDAT chunks parsing, can be single or multiples
+    const std::vector<const ChunkWalker::Chunk *> &datas(chunks.find_all("IDAT"));
+    if (datas.empty())
+        throw std::runtime_error("Missing IDAT chunk in \"" + source + "\"");
+
+    Info decoded = decoded_info(info, options);
+    const int scale = options.scale;
+    const int regionWidth = (options.region.width == 0) ? info.width - options.region.x : options.region.width;
+    const int regionHeight = (options.region.height == 0) ? info.height - options.region.y : options.region.height;
+    const std::size_t columnOffset = static_cast<std::size_t>(options.region.x) * info.colorChannel;
+    const bool completeRows = (regionWidth == info.width && scale == 1);
+    const int firstRow = options.region.y, endRow = firstRow + regionHeight;
+
+    // packed pixels (palette, grayscale of less than 8 bits) are unfiltered byte per byte then expanded
+    int width(0), height(0);
+    uint8_t bitDepth(0), colorMode(0), interlacing(0);
+    IHDR_CHUNK::read_datas(chunks.find("IHDR")->data, width, height, bitDepth, colorMode, interlacing);
+    const bool packed = PixelExpander::is_packed(bitDepth, colorMode);
+    PixelExpander expander(packed ? bitDepth : 8, packed ? colorMode : 0, chunks.find("PLTE"), chunks.find("tRNS"));
+    const std::size_t lineLength = PixelExpander::get_lineLength(width, bitDepth, colorMode);
+    const int filterDistance = packed ? 1 : info.colorChannel;
+
+    // 16 bits samples in the cpu byte order are swapped while the rows are copied from the scratch lines
+    const bool swapped = options.nativeOrder && info.bitDepth == 16 && !Utilities::is_bigEndian();
+
+    // two scratch lines, the previous unfiltered line must stay unchanged while the next one is unfiltered
+    std::vector<uint8_t> scratch((firstRow > 0 || !completeRows || packed || interlacing != 0 || swapped) ? 2 * lineLength : 0);
+    std::vector<uint8_t> expanded((packed && (!completeRows || interlacing != 0)) ? info.row_bytes() : 0);
+
+    // reduced decoding : one sum per sample of the reduced row, samples of 1 or 2 bytes (big endian)
+    const int sampleSize = info.bitDepth / 8, samples = info.colorChannel / sampleSize;
+    std::vector<uint32_t> sums((scale > 1) ? static_cast<std::size_t>(decoded.width) * samples : 0);
+
+    // storing an expanded image row of the region : its region columns are copied, or summed then averaged every scale rows
+    auto store_row = [&](int i, const uint8_t *line)
     {
-    case 0x0: // filter mode 0(none), output buffer is the same as the in buffer
-        memcpy(line_out, line_in, lineLength);
-        break;
-
-    case 0x1: // filter mode 1(Sub),
-        memcpy(line_out, line_in, colorChannel);
-
-        for (i = colorChannel; i < lineLength; i++)
-            line_out[i] = (uint8_t)(line_in[i] + line_out[i - colorChannel]);
-        break;
+        if (scale == 1)
+        {
+            uint8_t *out = buffer + static_cast<std::size_t>(i - firstRow) * stride;
+            if (swapped)
+                Filters::swap_samples16(out, line + columnOffset, static_cast<int>(decoded.row_bytes()));
+            else
+                std::memcpy(out, line + columnOffset, decoded.row_bytes());
+            return;
+        }
 
-    case 0x2: // filter mode 2(Up)
-        if (!is_prev_line)
-            memcpy(line_out, line_in, lineLength);
+        // the samples of the region are summed in their block column
+        const uint8_t *pixel = line + columnOffset;
+        for (int x = 0; x < regionWidth; x++)
+        {
+            uint32_t *sum = sums.data() + static_cast<std::size_t>(x / scale) * samples;
+            for (int c = 0; c < samples; c++, pixel += sampleSize)
+                sum[c] += (sampleSize == 1) ? pixel[0] : (pixel[0] << 8 | pixel[1]);
+        }
 
-        else
-            for (i = 0; i < lineLength; i++)
-                line_out[i] = (uint8_t)(line_in[i] + unfiltered_prev_line[i]);
-        break;
+        // the reduced row is emitted after the last line of its blocks
+        int blockRow = (i - firstRow) / scale;
+        if ((i - firstRow) % scale != scale - 1 && i != endRow - 1)
+            return;
 
-    case 0x3: // filter mode 3(Average)
-        if (!is_prev_line)
+        uint8_t *out = buffer + static_cast<std::size_t>(blockRow) * stride;
+        int blockHeight = std::min(scale, regionHeight - blockRow * scale);
+        for (int x = 0; x < decoded.width; x++)
         {
-            memcpy(line_out, line_in, colorChannel);
-
-            for (i = colorChannel; i < lineLength; i++)
-                line_out[i] = (uint8_t)(line_in[i] + floor((line_out[i - colorChannel]) / 2));
+            uint32_t count = static_cast<uint32_t>(std::min(scale, regionWidth - x * scale) * blockHeight);
+            uint32_t *sum = sums.data() + static_cast<std::size_t>(x) * samples;
+            for (int c = 0; c < samples; c++, out += sampleSize)
+            {
+                uint32_t average = (sum[c] + count / 2) / count;
+                if (sampleSize == 1)
+                    out[0] = static_cast<uint8_t>(average);
+                else if (swapped)
+                {
+                    uint16_t sample = static_cast<uint16_t>(average);
+                    std::memcpy(out, &sample, 2);
+                }
+                else
+                {
+                    out[0] = static_cast<uint8_t>(average >> 8);
+                    out[1] = static_cast<uint8_t>(average);
+                }
+                sum[c] = 0;
+            }
         }
-        else
+    };
+
+    try
+    {
+        ScanlineDecoder decoder(datas, static_cast<int>(lineLength), filterDistance);
+        if (interlacing != 0)
         {
-            for (i = 0; i < colorChannel; i++)
-                line_out[i] = (uint8_t)(line_in[i] + (floor((unfiltered_prev_line[i]) / 2)));
+            // the passes are scattered directly in the output buffer for a whole image, else in a grid image from which the region is stored :
+            // the full image without scale, else only its pixels (x, y) with x % scale == 0 and y % scale == 0, decoded by the first passes
+            const bool wholeImage = completeRows && firstRow == 0 && regionHeight == info.height && !swapped;
+            const int gridWidth = (width + scale - 1) / scale, gridHeight = (height + scale - 1) / scale;
+            const int lastPass = Adam7::get_gridPass(scale);
+            const std::size_t gridRowBytes = static_cast<std::size_t>(gridWidth) * info.colorChannel;
+            std::vector<uint8_t> image(wholeImage ? 0 : gridRowBytes * gridHeight);
+            uint8_t *pixels = wholeImage ? buffer : image.data();
+            const std::size_t pixelsStride = wholeImage ? stride : gridRowBytes;
+
+            for (int pass = 0; pass <= lastPass; pass++)
+            {
+                const int passWidth = Adam7::get_passWidth(pass, width), passHeight = Adam7::get_passHeight(pass, height);
+                const std::size_t passLength = PixelExpander::get_lineLength(passWidth, bitDepth, colorMode);
+                decoder.next_pass(static_cast<int>(passLength));
+
+                for (int j = 0; passWidth > 0 && j < passHeight; j++)
+                {
+                    uint8_t *line = scratch.data() + (j & 1) * passLength;
+                    decoder.next_line(line);
+                    if (packed)
+                    {
+                        expander.expand_line(expanded.data(), line, passWidth);
+                        line = expanded.data();
+                    }
+                    Adam7::scatter_line(pixels + (Adam7::get_passRow(pass, j) / scale) * pixelsStride, line, pass, width, info.colorChannel, scale);
+                }
+
+                // progressive rendering, the decoding can stop with a coarse image
+                if (options.onPass && !options.onPass(pass + 1, pixels, pixelsStride))
+                {
+                    Adam7::fill_missing(pixels, pixelsStride, gridWidth, gridHeight, info.colorChannel, pass, scale);
+                    break;
+                }
+            }
 
-            for (i = colorChannel; i < lineLength; i++)
-                line_out[i] = (uint8_t)(line_in[i] + floor((line_out[i - colorChannel] + unfiltered_prev_line[i]) / 2));
+            if (scale == 1)
+            {
+                for (int i = firstRow; !wholeImage && i < endRow; i++)
+                    store_row(i, pixels + static_cast<std::size_t>(i) * pixelsStride);
+                return;
+            }
+
+            // each block takes the grid pixel it contains, or the one of the top left of its cell for a partial block without grid pixel
+            auto grid_index = [scale](int first, int end) { return std::min((first + scale - 1) / scale, (end - 1) / scale); };
+            for (int y = 0; y < decoded.height; y++)
+            {
+                const int top = firstRow + y * scale;
+                const uint8_t *gridRow = pixels + static_cast<std::size_t>(grid_index(top, std::min(top + scale, endRow))) * pixelsStride;
+                uint8_t *out = buffer + static_cast<std::size_t>(y) * stride;
+                for (int x = 0; x < decoded.width; x++, out += info.colorChannel)
+                {
+                    const int left = options.region.x + x * scale;
+                    const uint8_t *pixel = gridRow + static_cast<std::size_t>(grid_index(left, std::min(left + scale, options.region.x + regionWidth))) * info.colorChannel;
+                    if (swapped)
+                        Filters::swap_samples16(out, pixel, info.colorChannel);
+                    else
+                        std::memcpy(out, pixel, info.colorChannel);
+                }
+            }
+            return;
         }
-        break;
 
-    case 0x4: // filter mode 4(Paeth)
-        if (!is_prev_line)
+        for (int i = 0; i < endRow; i++)
         {
-            memcpy(line_out, line_in, colorChannel);
+            if (i >= firstRow && completeRows && !packed && !swapped)
+            {
+                decoder.next_line(buffer + static_cast<std::size_t>(i - firstRow) * stride); // the line is unfiltered in place at its row
+                continue;
+            }
 
-            for (i = colorChannel; i < lineLength; i++)
-                line_out[i] = (uint8_t)(line_in[i] + Utilities::paeth_predictor(line_out[i - colorChannel], 0, 0));
-        }
-        else
-        {
-            for (i = 0; i < colorChannel; i++)
-                line_out[i] = (uint8_t)(line_in[i] + unfiltered_prev_line[i]); 
+            uint8_t *line = scratch.data() + (i & 1) * lineLength;
+            decoder.next_line(line);
+            if (i < firstRow)
+                continue;
 
-            for (i = colorChannel; i < lineLength; i++)
-                line_out[i] = (uint8_t)(line_in[i] + Utilities::paeth_predictor(line_out[i - colorChannel], unfiltered_prev_line[i], unfiltered_prev_line[i - colorChannel]));
+            // the packed line is expanded directly at its row, or in a scratch line for the region columns or the reduction
+            if (packed && completeRows)
+            {
+                expander.expand_line(buffer + static_cast<std::size_t>(i - firstRow) * stride, line, width);
+                continue;
+            }
+            if (packed)
+            {
+                expander.expand_line(expanded.data(), line, width);
+                line = expanded.data();
+            }
+            store_row(i, line);
         }
-        break;
-
-    default:
-        throw std::invalid_argument("Invalid filter mode is specified : 0x" + std::to_string(filterMode));
-        break;
     }
-    return line_out;
+    catch (const std::exception &exception)
+    {
+        throw std::runtime_error("\"" + source + "\" : " + exception.what());
+    }
 }
 
+
 /**
  * @brief get png width
  * 
@@ -579,15 +1035,7 @@ uint8_t *PNG::get_raw_pixels() const
 {
     using namespace std::literals;
 
-    uint8_t colorChannels {0};
-    if(this->get_colorMode() == 0x0)
-        colorChannels = 1 * (this->get_bitDepth() / 8);
-    if(this->get_colorMode() == 0x1) 
-        colorChannels = 2 * (this->get_bitDepth() / 8);
-    else if (this->get_colorMode() == 0x2)
-        colorChannels = 3 * (this->get_bitDepth() / 8);
-    else if (this->get_colorMode() == 0x6)
-        colorChannels = 4 * (this->get_bitDepth() / 8);
+    uint8_t colorChannels = get_colorChannels(this->get_bitDepth(), this->get_colorMode());
 
     int pixels_len = this->m_IHDR->m_width * this->m_IHDR->m_height * colorChannels;  
 
@@ -601,21 +1049,52 @@ uint8_t *PNG::get_raw_pixels() const
         throw std::runtime_error("Error : no memory avaible for getting PNG raw pixels : \n"s + exception.what());
     }
 
-    std::memcpy(output, this->m_pixelBuffer, pixels_len);
+    std::memcpy(output, this->m_pixelBuffer.get(), pixels_len);
     return output;
 }
 
+/**
+ * @brief replace the raw pixels of a png, the encoded scanlines are dropped and will be encoded again on the next save
+ * @details if the pixels buffer is shared with copies of the png, this png gets its own buffer (copy on write).
+ * 
+ * @param pixelBuffer the new raw pixels, copied, with the same size, bit depth and color mode as the png
+ */
+void PNG::set_raw_pixels(const uint8_t *pixelBuffer)
+{
+    if (m_pixelBuffer.use_count() > 1)
+        m_pixelBuffer.reset(new uint8_t[get_raw_pix_size()]);
+
+    std::memcpy(m_pixelBuffer.get(), pixelBuffer, get_raw_pix_size());
+    m_IDAT.reset();
+    m_PLTE.reset();
+    m_tRNS.reset();
+}
+
 int PNG::get_raw_pix_size() const noexcept
 {
-    uint8_t colorChannels {0};
-    if(this->get_colorMode() == 0x0)
-        colorChannels = 1 * (this->get_bitDepth() / 8);
-    if(this->get_colorMode() == 0x1) 
-        colorChannels = 2 * (this->get_bitDepth() / 8);
-    else if (this->get_colorMode() == 0x2)
-        colorChannels = 3 * (this->get_bitDepth() / 8);
-    else if (this->get_colorMode() == 0x6)
-        colorChannels = 4 * (this->get_bitDepth() / 8);
+    uint8_t colorChannels = get_colorChannels(this->get_bitDepth(), this->get_colorMode());
 
     return this->m_IHDR->m_width * this->m_IHDR->m_height * colorChannels;  
-}
\ No newline at end of file
+}
+
+/**
+ * @brief get the number of bytes per pixel of a png
+ * 
+ * @param bitDepth the png bit depth, 8 or 16
+ * @param colorMode the png color mode, 0(grayscale), 4(grayscale alpha), 2(RGB true color) or 6(RGBA)
+ * @return uint8_t the number of bytes per pixel, 0 for an unmanaged color mode
+ */
+uint8_t PNG::get_colorChannels(int bitDepth, int colorMode) noexcept
+{
+    uint8_t colorChannels {0};
+    if (colorMode == 0x0)
+        colorChannels = 1;
+    else if (colorMode == 0x4)
+        colorChannels = 2;
+    else if (colorMode == 0x2)
+        colorChannels = 3;
+    else if (colorMode == 0x6)
+        colorChannels = 4;
+
+    return colorChannels * (bitDepth / 8);
+}
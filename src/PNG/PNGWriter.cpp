@@ -0,0 +1,264 @@
+#include <cstring>
+
+#include "../../include/PNG/PNG.h"
+#include "../../include/PNG/CRC32.h"
+#include "../../include/PNG/Filters.h"
+#include "../../include/PNG/Utilities.h"
+#include "../../include/PNG/PNGWriter.h"
+
+
+/**
+ * @brief Construct a new PNGWriter::PNGWriter object, writing the png signature and the IHDR chunk
+ *
+ * @param path the png file path to create
+ * @param s_width the png width
+ * @param s_height the png height
+ * @param bitDepth the png bit depth, 8 or 16
+ * @param colorMode the png color mode, only managed are 0(grayscale), 4(grayscale alpha), 2(RGB true color) and 6(RGBA)
+ * @param options the encoding options (zlib parameters and filter selection strategy), EncodeOptions::threads is ignored
+ * @param chunkSize the IDAT chunks datas length
+ *
+ * @exception std::invalid_argument case Invalid image format or encoding options
+ * @exception std::runtime_error if cannot create file as specified path, or if the trial deflate stream cannot be initialised
+ */
+PNGWriter::PNGWriter(const std::string &path, int s_width, int s_height, int bitDepth, int colorMode, const EncodeOptions &options, int chunkSize)
+    : m_options(options), m_height(s_height), m_chunkSize(chunkSize)
+{
+    m_colorChannel = PNG::get_colorChannels(bitDepth, colorMode);
+    if ((bitDepth != 8 && bitDepth != 16) || m_colorChannel == 0)
+        throw std::invalid_argument("PNGWriter - Unmanaged bit depth " + std::to_string(bitDepth) + " and color mode " + std::to_string(colorMode));
+    if (s_width <= 0 || s_height <= 0 || chunkSize <= 0)
+        throw std::invalid_argument("PNGWriter - Invalid png size " + std::to_string(s_width) + "x" + std::to_string(s_height) + " or IDAT chunk size");
+    if (options.windowBits < 9 || options.windowBits > 15) // a png zlib stream can't use a window larger than 32K
+        throw std::invalid_argument("Invalid deflate window bits : " + std::to_string(options.windowBits));
+
+    int level = options.level;
+    if (options.store) // store mode, no filtering and no compression
+    {
+        m_options.filtering.selection = Filters::Selection::FIXED;
+        m_options.filtering.fixedFilter = 0x0;
+        level = Z_NO_COMPRESSION;
+    }
+    if (m_options.filtering.selection == Filters::Selection::FIXED && m_options.filtering.fixedFilter > 0x4)
+        throw std::invalid_argument("Invalid filter mode is specified : 0x" + std::to_string(m_options.filtering.fixedFilter));
+
+    m_lineLength = s_width * m_colorChannel;
+    m_prevLine.assign(m_lineLength, 0);
+    m_scanline.resize(1 + m_lineLength);
+    m_chunk.resize(4 + chunkSize);
+    std::memcpy(m_chunk.data(), "IDAT", 4);
+
+    // initialising zlib
+    m_stream.zalloc = m_trialStream.zalloc = Z_NULL;
+    m_stream.zfree = m_trialStream.zfree = Z_NULL;
+    m_stream.opaque = m_trialStream.opaque = Z_NULL;
+
+    if (deflateInit2(&m_stream, level, Z_DEFLATED, options.windowBits, options.memLevel, options.strategy) != Z_OK)
+        throw std::invalid_argument("Invalid deflate parameters : level " + std::to_string(level) + ", strategy " + std::to_string(options.strategy) + ", memLevel " + std::to_string(options.memLevel));
+    m_stream.next_out = m_chunk.data() + 4;
+    m_stream.avail_out = chunkSize;
+
+    try
+    {
+        if (m_options.filtering.selection == Filters::Selection::BRUTE_FORCE) // the trial stream is only needed by the brute force strategy
+        {
+            if (deflateInit2(&m_trialStream, std::max(1, level), Z_DEFLATED, options.windowBits, options.memLevel, options.strategy) != Z_OK)
+                throw std::runtime_error("Enable to initialise trial deflate stream");
+            m_trialInitialised = true;
+            m_trialDatas.resize(deflateBound(&m_trialStream, m_lineLength));
+        }
+
+        m_sink = new FileSink(path); // Opening the output file
+
+        static const uint8_t signature[8] = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A};
+        m_sink->write(signature, 8);
+        IHDR_CHUNK(s_width, s_height, bitDepth, colorMode).save(*m_sink);
+    }
+    catch (const std::runtime_error &exception)
+    {
+        release();
+        throw std::runtime_error(std::string("PNGWriter - ") + exception.what());
+    }
+    catch (...)
+    {
+        release();
+        throw;
+    }
+}
+
+/**
+ * @brief Destroy the PNGWriter::PNGWriter object
+ * @warning if PNGWriter::finish() has not been called, the written png file is incomplete.
+ *
+ */
+PNGWriter::~PNGWriter()
+{
+    release();
+}
+
+/**
+ * @brief close the file and free the deflate streams, the trial stream only if it has been initialised
+ *
+ */
+void PNGWriter::release() noexcept
+{
+    delete m_sink;
+    m_sink = nullptr;
+    deflateEnd(&m_stream);
+    if (m_trialInitialised)
+        deflateEnd(&m_trialStream);
+    m_trialInitialised = false;
+}
+
+/**
+ * @brief filter and deflate the next rows of the png
+ * @details full IDAT chunks are written to the file as soon as they are filled.
+ *
+ * @param rows the rows raw pixels, rowNumber contiguous rows of width * bytes per pixel bytes
+ * @param rowNumber the number of rows
+ *
+ * @exception std::runtime_error if more rows than the png height are written, or if the png is already finished
+ * @exception std::runtime_error if cannot write in the file
+ */
+void PNGWriter::write_rows(const uint8_t *rows, int rowNumber)
+{
+    if (m_finished || rowNumber < 0 || m_rows + rowNumber > m_height)
+        throw std::runtime_error("PNGWriter - Too many rows written : " + std::to_string(m_rows + rowNumber) + " for a height of " + std::to_string(m_height));
+    if (rowNumber == 0)
+        return;
+
+    for (int i = 0; i < rowNumber; ++i)
+    {
+        const uint8_t *line = rows + static_cast<std::size_t>(i) * m_lineLength;
+        const uint8_t *prev_line = (i == 0) ? m_prevLine.data() : line - m_lineLength; // rows of the same call don't need any copy
+
+        m_scanline[0] = select_filter(line, prev_line); // writing filter mode byte
+        Filters::filter_line(m_scanline.data() + 1, line, prev_line, m_lineLength, m_scanline[0], m_colorChannel);
+        deflate_scanline(Z_NO_FLUSH);
+        ++m_rows;
+    }
+
+    // the last row is kept for filtering the first row of the next call
+    std::memcpy(m_prevLine.data(), rows + static_cast<std::size_t>(rowNumber - 1) * m_lineLength, m_lineLength);
+}
+
+/**
+ * @brief end the png : the deflate stream is finished, the last IDAT chunk and the IEND chunk are written and the file is closed
+ *
+ * @exception std::runtime_error if all the rows have not been written
+ * @exception std::runtime_error if cannot write in the file
+ */
+void PNGWriter::finish()
+{
+    if (m_finished)
+        return;
+    if (m_rows != m_height)
+        throw std::runtime_error("PNGWriter - Missing rows : " + std::to_string(m_rows) + " written for a height of " + std::to_string(m_height));
+
+    deflate_scanline(Z_FINISH);
+    flush_chunk();
+    IEND_CHUNK().save(*m_sink);
+
+    m_finished = true;
+    m_sink->close();
+}
+
+/**
+ * @brief get the number of rows already written
+ *
+ * @return int
+ */
+int PNGWriter::get_written_rows() const noexcept
+{
+    return m_rows;
+}
+
+/**
+ * @brief get the filter mode of a row, according to the filter selection strategy
+ * @see Filters::Strategy
+ *
+ * @param line the row to filter
+ * @param prev_line the previous row (not filtered)
+ * @return uint8_t the filter mode
+ */
+uint8_t PNGWriter::select_filter(const uint8_t *line, const uint8_t *prev_line)
+{
+    switch (m_options.filtering.selection)
+    {
+    case Filters::Selection::FIXED:
+        m_filterMode = m_options.filtering.fixedFilter;
+        break;
+
+    case Filters::Selection::ADAPTIVE_FAST: // the rows between two scored rows reuse the last choice
+        if (m_rows % std::max(1, m_options.filtering.rescoreInterval) == 0)
+            m_filterMode = Filters::select_filter(line, prev_line, m_lineLength, m_colorChannel);
+        break;
+
+    case Filters::Selection::BRUTE_FORCE:
+        m_filterMode = IDAT_CHUNK::trial_filter(m_trialStream, m_trialDatas, m_scanline.data() + 1, line, prev_line, m_lineLength, m_colorChannel);
+        break;
+
+    default:
+        m_filterMode = Filters::select_filter(line, prev_line, m_lineLength, m_colorChannel);
+        break;
+    }
+    return m_filterMode;
+}
+
+/**
+ * @brief deflate the current scanline (Z_NO_FLUSH) or end the deflate stream (Z_FINISH), writing each filled IDAT chunk
+ *
+ * @param flush the zlib flush mode, Z_NO_FLUSH or Z_FINISH
+ *
+ * @exception std::runtime_error if the deflate stream fails or if cannot write in the file
+ */
+void PNGWriter::deflate_scanline(int flush)
+{
+    if (flush == Z_NO_FLUSH)
+    {
+        m_stream.next_in = m_scanline.data();
+        m_stream.avail_in = static_cast<uInt>(m_scanline.size());
+    }
+
+    for (;;)
+    {
+        int result = deflate(&m_stream, flush);
+        if (result == Z_STREAM_ERROR)
+            throw std::runtime_error("PNGWriter - Deflate stream error");
+        if (flush == Z_FINISH && result == Z_STREAM_END)
+            break;
+
+        if (m_stream.avail_out == 0) // the IDAT chunk is full
+            flush_chunk();
+        else if (flush == Z_NO_FLUSH) // output space left : the whole scanline has been consumed
+            break;
+    }
+}
+
+/**
+ * @brief write the IDAT chunk being filled, if not empty, and start a new one
+ *
+ * @exception std::runtime_error if cannot write in the file
+ */
+void PNGWriter::flush_chunk()
+{
+    int dataLen = m_chunkSize - static_cast<int>(m_stream.avail_out);
+    if (dataLen > 0)
+        write_chunk(m_chunk.data(), dataLen);
+
+    m_stream.next_out = m_chunk.data() + 4;
+    m_stream.avail_out = m_chunkSize;
+}
+
+/**
+ * @brief write a chunk (length, type, datas, crc32) in the file
+ *
+ * @param typeAndDatas the chunk type followed by its datas
+ * @param dataLen the chunk datas length
+ *
+ * @exception std::runtime_error if cannot write in the file
+ */
+void PNGWriter::write_chunk(const uint8_t *typeAndDatas, int dataLen)
+{
+    m_sink->write_chunk(typeAndDatas, typeAndDatas + 4, static_cast<uint32_t>(dataLen), CRC32::update(0, typeAndDatas, 4 + dataLen));
+}
@@ -0,0 +1,274 @@
+#include <cstring>
+#include <algorithm>
+
+#include "../../include/PNG/Palette.h"
+#include "../../include/PixelsManager/PixelsManager.h"
+
+
+/**
+ * @brief Construct a new Palette::Palette object, collecting the colors of the pixels
+ * @details the colors are collected while there are at most 256 of them, transparent colors are placed first so that
+ * the tRNS chunk is as short as possible. Otherwise, RGB pixels are quantized if asked.
+ *
+ * @param pixels the pixels buffer, 8 bits RGB or RGBA
+ * @param pixelNumber the number of pixels
+ * @param colorChannel the number of bytes per pixel, 3 (RGB) or 4 (RGBA)
+ * @param quantize true for quantizing RGB pixels of more than 256 colors
+ * @param iterations the number of k-means iterations of the quantization
+ */
+Palette::Palette(const uint8_t *pixels, int pixelNumber, int colorChannel, bool quantize, int iterations)
+    : m_colorChannel(colorChannel)
+{
+    std::fill(m_indices, m_indices + hashSize, -1);
+    if (pixelNumber <= 0 || (colorChannel != 3 && colorChannel != 4))
+        return;
+
+    // flat images have long runs of a single color, the hash table is only searched when the color changes
+    bool overflow = false;
+    uint32_t previous = ~get_color(pixels, colorChannel);
+    for (int i = 0; i < pixelNumber; ++i)
+    {
+        uint32_t color = get_color(pixels + static_cast<std::size_t>(i) * colorChannel, colorChannel);
+        if (color == previous)
+            continue;
+        previous = color;
+
+        if (find(color) >= 0)
+            continue;
+        if (m_colors.size() == maxEntries)
+        {
+            overflow = true;
+            break;
+        }
+        insert(color, static_cast<int>(m_colors.size()));
+        m_colors.push_back(color);
+    }
+
+    if (!overflow)
+    {
+        // the transparent colors first, then the hash table is built again with the final indices
+        std::stable_partition(m_colors.begin(), m_colors.end(), [](uint32_t color) { return (color >> 24) != 0xFF; });
+        std::fill(m_indices, m_indices + hashSize, -1);
+        for (std::size_t i = 0; i < m_colors.size(); ++i)
+            insert(m_colors[i], static_cast<int>(i));
+
+        m_exact = true;
+        return;
+    }
+
+    m_colors.clear();
+    if (!quantize || colorChannel != 3)
+        return;
+
+    // the palette is computed on a regular sample of the pixels, keeping the clustering time bounded
+    const int step = std::max(1, pixelNumber / maxSample);
+    std::vector<uint8_t> sample;
+    sample.reserve(static_cast<std::size_t>(pixelNumber / step + 1) * 3);
+    for (int i = 0; i < pixelNumber; i += step)
+        sample.insert(sample.end(), pixels + static_cast<std::size_t>(i) * 3, pixels + static_cast<std::size_t>(i) * 3 + 3);
+
+    int sampleLen = static_cast<int>(sample.size()), entries = PixelsManager::get_nb_colors(sample.data(), sampleLen);
+    uint8_t *rgb = nullptr;
+    if (entries <= maxEntries)
+        rgb = PixelsManager::get_high_occ_colors(sample.data(), sampleLen, entries);
+    else
+        rgb = PixelsManager::get_dominants_colors_kmean(sample.data(), sampleLen, maxEntries, iterations, entries);
+
+    for (int i = 0; i < entries; ++i)
+        m_colors.push_back(get_color(rgb + 3 * i, 3));
+    delete[] rgb;
+}
+
+/**
+ * @brief tell if the pixels can be encoded with the palette
+ *
+ * @return true if the palette is exact or quantized
+ */
+bool Palette::is_valid() const noexcept
+{
+    return !m_colors.empty();
+}
+
+/**
+ * @brief get the number of palette entries
+ *
+ * @return int from 1 to 256, 0 if the palette is not valid
+ */
+int Palette::get_entries() const noexcept
+{
+    return static_cast<int>(m_colors.size());
+}
+
+/**
+ * @brief get the number of transparent palette entries, they are the first ones
+ *
+ * @return int the length of the tRNS chunk, 0 if all the colors are opaque
+ */
+int Palette::get_transparent_entries() const noexcept
+{
+    int entries = 0;
+    while (entries < get_entries() && (m_colors[entries] >> 24) != 0xFF)
+        ++entries;
+    return entries;
+}
+
+/**
+ * @brief get the RGB colors of the palette entries
+ *
+ * @param rgb the output, 3 bytes per entry
+ */
+void Palette::get_colors(uint8_t *rgb) const noexcept
+{
+    for (uint32_t color : m_colors)
+    {
+        *rgb++ = static_cast<uint8_t>(color);
+        *rgb++ = static_cast<uint8_t>(color >> 8);
+        *rgb++ = static_cast<uint8_t>(color >> 16);
+    }
+}
+
+/**
+ * @brief get the alpha values of the palette entries
+ *
+ * @param alphas the output, 1 byte per entry
+ */
+void Palette::get_alphas(uint8_t *alphas) const noexcept
+{
+    for (uint32_t color : m_colors)
+        *alphas++ = static_cast<uint8_t>(color >> 24);
+}
+
+/**
+ * @brief get the packed palette indices of the pixels, as png lines (without filter byte)
+ * @details quantized colors are searched once for their nearest palette color, the result is kept in a direct mapped cache.
+ *
+ * @param pixels the pixels buffer, with the colors of the palette
+ * @param s_width the image width
+ * @param s_height the image height
+ * @param bitDepth the bit depth of the indices, 1, 2, 4 or 8, large enough for the palette entries
+ * @return std::vector<uint8_t> the lines of indices, (s_width * bitDepth + 7) / 8 bytes each
+ */
+std::vector<uint8_t> Palette::index_pixels(const uint8_t *pixels, int s_width, int s_height, uint8_t bitDepth) const
+{
+    const std::size_t lineLength = (static_cast<std::size_t>(s_width) * bitDepth + 7) / 8;
+    std::vector<uint8_t> indices(lineLength * s_height, 0);
+
+    constexpr int cacheSize = 4096;
+    std::vector<uint32_t> cacheKeys(m_exact ? 0 : cacheSize);
+    std::vector<int16_t> cacheIndices(m_exact ? 0 : cacheSize, -1);
+
+    const uint8_t *pixel = pixels;
+    for (int y = 0; y < s_height; ++y)
+    {
+        uint8_t *line = indices.data() + y * lineLength;
+        for (int x = 0; x < s_width; ++x, pixel += m_colorChannel)
+        {
+            uint32_t color = get_color(pixel, m_colorChannel);
+            int index = 0;
+            if (m_exact)
+                index = find(color);
+            else
+            {
+                uint32_t slot = hash(color) & (cacheSize - 1);
+                if (cacheIndices[slot] < 0 || cacheKeys[slot] != color)
+                {
+                    cacheKeys[slot] = color;
+                    cacheIndices[slot] = static_cast<int16_t>(nearest(color));
+                }
+                index = cacheIndices[slot];
+            }
+
+            // the indices are packed from the most significant bits
+            if (bitDepth == 8)
+                line[x] = static_cast<uint8_t>(index);
+            else
+            {
+                int bit = x * bitDepth;
+                line[bit >> 3] |= static_cast<uint8_t>(index << (8 - bitDepth - (bit & 7)));
+            }
+        }
+    }
+
+    return indices;
+}
+
+/**
+ * @brief get the packed RGBA color of a pixel, RGB pixels are opaque
+ *
+ * @param pixel the pixel bytes
+ * @param colorChannel the number of bytes per pixel, 3 (RGB) or 4 (RGBA)
+ * @return uint32_t the color, packed as r | g << 8 | b << 16 | a << 24
+ */
+uint32_t Palette::get_color(const uint8_t *pixel, int colorChannel) noexcept
+{
+    uint32_t alpha = (colorChannel == 4) ? pixel[3] : 0xFF;
+    return pixel[0] | (pixel[1] << 8) | (pixel[2] << 16) | (alpha << 24);
+}
+
+/**
+ * @brief hash a packed color (multiplicative hashing)
+ *
+ * @param color the packed color
+ * @return uint32_t the hash, its high bits are the best distributed
+ */
+uint32_t Palette::hash(uint32_t color) noexcept
+{
+    return (color * 2654435761u) >> 16;
+}
+
+/**
+ * @brief search a color in the hash table
+ *
+ * @param color the packed color
+ * @return int the palette index of the color, -1 if the color is not in the palette
+ */
+int Palette::find(uint32_t color) const noexcept
+{
+    for (uint32_t slot = hash(color) & (hashSize - 1);; slot = (slot + 1) & (hashSize - 1))
+    {
+        if (m_indices[slot] < 0)
+            return -1;
+        if (m_keys[slot] == color)
+            return m_indices[slot];
+    }
+}
+
+/**
+ * @brief insert a color in the hash table (linear probing), the table is never more than 1/4 full
+ *
+ * @param color the packed color
+ * @param index the palette index of the color
+ */
+void Palette::insert(uint32_t color, int index) noexcept
+{
+    uint32_t slot = hash(color) & (hashSize - 1);
+    while (m_indices[slot] >= 0)
+        slot = (slot + 1) & (hashSize - 1);
+
+    m_keys[slot] = color;
+    m_indices[slot] = static_cast<int16_t>(index);
+}
+
+/**
+ * @brief search the nearest palette color of an RGB color (squared euclidean distance)
+ *
+ * @param color the packed color
+ * @return int the palette index of the nearest color
+ */
+int Palette::nearest(uint32_t color) const noexcept
+{
+    const int r = color & 0xFF, g = (color >> 8) & 0xFF, b = (color >> 16) & 0xFF;
+
+    int best = 0, bestDistance = 0x7FFFFFFF;
+    for (std::size_t i = 0; i < m_colors.size(); ++i)
+    {
+        int dr = r - static_cast<int>(m_colors[i] & 0xFF), dg = g - static_cast<int>((m_colors[i] >> 8) & 0xFF), db = b - static_cast<int>((m_colors[i] >> 16) & 0xFF);
+        int distance = dr * dr + dg * dg + db * db;
+        if (distance < bestDistance)
+        {
+            bestDistance = distance;
+            best = static_cast<int>(i);
+        }
+    }
+    return best;
+}
@@ -0,0 +1,153 @@
+#include <cstring>
+
+#include "../../include/PNG/PixelExpander.h"
+
+
+/**
+ * @brief Construct a new PixelExpander::PixelExpander object, computing the unpacking and palette tables
+ *
+ * @param bitDepth the png bit depth : 1, 2, 4, or 8 for palette pngs
+ * @param colorMode the png color mode : 0 (grayscale) or 3 (palette)
+ * @param palette the PLTE chunk record, nullptr for grayscale pngs
+ * @param transparency the tRNS chunk record, nullptr if the png has no tRNS chunk
+ *
+ * @exception std::runtime_error if the PLTE chunk of a palette png is missing or invalid
+ */
+PixelExpander::PixelExpander(uint8_t bitDepth, uint8_t colorMode, const ChunkWalker::Chunk *palette, const ChunkWalker::Chunk *transparency)
+    : m_bitDepth(bitDepth), m_colorMode(colorMode), m_colorChannel(1)
+{
+    const int perByte = 8 / bitDepth, maxValue = (1 << bitDepth) - 1;
+
+    // the samples of each byte, from the most significant bits, grayscale samples are scaled to 8 bits
+    for (int byte = 0; byte < 256; ++byte)
+        for (int k = 0; k < 8; ++k)
+        {
+            int value = (k < perByte) ? (byte >> (8 - bitDepth * (k + 1))) & maxValue : 0;
+            m_unpack[byte][k] = static_cast<uint8_t>((colorMode == 0) ? value * 255 / maxValue : value);
+        }
+
+    std::memset(m_palette, 0, sizeof(m_palette));
+    if (colorMode != 3)
+        return;
+
+    if (palette == nullptr || palette->length == 0 || palette->length % 3 != 0 || palette->length > 768)
+        throw std::runtime_error("Missing or invalid PLTE chunk");
+
+    for (uint32_t i = 0; i < 256; ++i)
+        m_palette[i][3] = 255;
+    for (uint32_t i = 0; i < palette->length / 3; ++i)
+        std::memcpy(m_palette[i], palette->data + 3 * i, 3);
+
+    // the tRNS chunk gives the alpha of the first palette entries, the others are opaque
+    m_colorChannel = 3;
+    if (transparency != nullptr)
+    {
+        m_colorChannel = 4;
+        for (uint32_t i = 0; i < transparency->length && i < 256; ++i)
+            m_palette[i][3] = transparency->data[i];
+    }
+}
+
+/**
+ * @brief expand a packed line
+ *
+ * @param line_out the expanded line, width * colorChannel bytes
+ * @param line the unfiltered packed line
+ * @param width the line width, in pixels
+ */
+void PixelExpander::expand_line(uint8_t *line_out, const uint8_t *line, int width) const noexcept
+{
+    if (m_colorMode == 3)
+    {
+        if (m_colorChannel == 4)
+            expand_palette<4>(line_out, line, width);
+        else
+            expand_palette<3>(line_out, line, width);
+        return;
+    }
+
+    // grayscale : the samples of each full byte are copied at once, then the samples of the last partial byte
+    const int perByte = 8 / m_bitDepth, bytes = width / perByte;
+    for (int i = 0; i < bytes; ++i, line_out += perByte)
+    {
+        if (perByte == 8)
+            std::memcpy(line_out, m_unpack[line[i]], 8);
+        else if (perByte == 4)
+            std::memcpy(line_out, m_unpack[line[i]], 4);
+        else
+            std::memcpy(line_out, m_unpack[line[i]], 2);
+    }
+    if (width > bytes * perByte)
+        std::memcpy(line_out, m_unpack[line[bytes]], width - bytes * perByte);
+}
+
+/**
+ * @brief expand a line of palette indices to RGB or RGBA colors
+ * @details each color is copied with a 4 bytes store, for RGB colors the extra byte is overwritten by the next color,
+ * only the last color is copied on 3 bytes.
+ *
+ * @tparam colorChannel 3 (RGB) or 4 (RGBA)
+ * @param line_out the expanded line, width * colorChannel bytes
+ * @param line the unfiltered line of indices
+ * @param width the line width, in pixels
+ */
+template <int colorChannel>
+void PixelExpander::expand_palette(uint8_t *line_out, const uint8_t *line, int width) const noexcept
+{
+    if (width <= 0)
+        return;
+
+    // log2 of the number of indices per byte : x >> shift is the byte of the index x, x & mask its position in the byte
+    const int shift = (m_bitDepth == 8) ? 0 : (m_bitDepth == 4) ? 1 : (m_bitDepth == 2) ? 2 : 3;
+    const int mask = (1 << shift) - 1, last = width - 1;
+
+    for (int x = 0; x < last; ++x, line_out += colorChannel)
+        std::memcpy(line_out, m_palette[m_unpack[line[x >> shift]][x & mask]], 4);
+    std::memcpy(line_out, m_palette[m_unpack[line[last >> shift]][last & mask]], colorChannel);
+}
+
+/**
+ * @brief get the color mode of the expanded pixels
+ *
+ * @return uint8_t 0 (grayscale), 2 (RGB) or 6 (RGBA)
+ */
+uint8_t PixelExpander::get_colorMode() const noexcept
+{
+    return (m_colorMode == 0) ? 0 : (m_colorChannel == 4) ? 6 : 2;
+}
+
+/**
+ * @brief get the number of bytes of the expanded pixels
+ *
+ * @return uint8_t 1 (grayscale), 3 (RGB) or 4 (RGBA)
+ */
+uint8_t PixelExpander::get_colorChannel() const noexcept
+{
+    return m_colorChannel;
+}
+
+/**
+ * @brief tell if the pixels of a png must be expanded to be 8 bits samples
+ *
+ * @param bitDepth the png bit depth
+ * @param colorMode the png color mode
+ * @return true for palette pngs and grayscale pngs of less than 8 bits
+ */
+bool PixelExpander::is_packed(uint8_t bitDepth, uint8_t colorMode) noexcept
+{
+    return colorMode == 3 || (colorMode == 0 && bitDepth < 8);
+}
+
+/**
+ * @brief get the length of a packed line (without filter byte)
+ *
+ * @param width the line width, in pixels
+ * @param bitDepth the png bit depth
+ * @param colorMode the png color mode
+ * @return int the line length, in bytes
+ */
+int PixelExpander::get_lineLength(int width, uint8_t bitDepth, uint8_t colorMode) noexcept
+{
+    const int samples = (colorMode == 2) ? 3 : (colorMode == 4) ? 2 : (colorMode == 6) ? 4 : 1;
+    return static_cast<int>((static_cast<int64_t>(width) * samples * bitDepth + 7) / 8);
+}
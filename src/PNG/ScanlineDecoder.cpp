@@ -0,0 +1,112 @@
+#include <string>
+#include <cstring>
+
+#include "../../include/PNG/Filters.h"
+#include "../../include/PNG/ScanlineDecoder.h"
+
+
+/**
+ * @brief Construct a new ScanlineDecoder::ScanlineDecoder object
+ *
+ * @param datas the IDAT chunks records, in file order
+ * @param lineLength the unfiltered line length in bytes (without the filter byte)
+ * @param colorChannel the number of bytes per pixel
+ *
+ * @exception std::runtime_error if the inflate stream cannot be initialised
+ */
+ScanlineDecoder::ScanlineDecoder(const std::vector<const ChunkWalker::Chunk *> &datas, int lineLength, int colorChannel)
+    : m_datas(datas), m_lineLength(lineLength), m_maxLineLength(lineLength), m_colorChannel(colorChannel)
+{
+    m_stream.zalloc = Z_NULL;
+    m_stream.zfree = Z_NULL;
+    m_stream.opaque = Z_NULL;
+    m_stream.avail_in = 0;
+    m_stream.next_in = Z_NULL;
+
+    if (inflateInit(&m_stream) != Z_OK)
+        throw std::runtime_error("ScanlineDecoder - Enable to initialise inflate stream");
+
+    m_zeroLine = new uint8_t[lineLength]();
+}
+
+/**
+ * @brief Destroy the ScanlineDecoder::ScanlineDecoder object
+ *
+ */
+ScanlineDecoder::~ScanlineDecoder()
+{
+    inflateEnd(&m_stream);
+    delete[] m_zeroLine;
+}
+
+/**
+ * @brief decode the next scanline, directly into the output line
+ * @details the filter byte is inflated first, then the line datas are inflated in line_out and unfiltered in place
+ * against the previous decoded line.
+ * @see Filters::unfilter_line
+ * @warning the previous output line must stay unchanged until this method returns, since it's used for unfiltering.
+ *
+ * @param line_out the destination of the unfiltered line, at least lineLength bytes
+ *
+ * @exception std::runtime_error if the IDAT datas are corrupted or truncated
+ * @exception std::invalid_argument case Invalid filter mode
+ */
+void ScanlineDecoder::next_line(uint8_t *line_out)
+{
+    uint8_t filterMode(0);
+    inflate_to(&filterMode, 1);
+    inflate_to(line_out, m_lineLength);
+
+    Filters::unfilter_line(line_out, (m_prevLine == nullptr) ? m_zeroLine : m_prevLine, m_lineLength, filterMode, m_colorChannel);
+    m_prevLine = line_out;
+}
+
+/**
+ * @brief start a new sub-image (Adam7 pass) : the next line is unfiltered against a line of 0
+ *
+ * @param lineLength the unfiltered line length of the sub-image, at most the line length given to the constructor
+ *
+ * @exception std::invalid_argument if the line length is greater than the line length given to the constructor
+ */
+void ScanlineDecoder::next_pass(int lineLength)
+{
+    if (lineLength > m_maxLineLength)
+        throw std::invalid_argument("ScanlineDecoder - Invalid pass line length");
+
+    m_lineLength = lineLength;
+    m_prevLine = nullptr;
+}
+
+/**
+ * @brief inflate a fixed number of bytes, feeding the stream with the next IDAT chunks when needed
+ *
+ * @param out the output buffer
+ * @param len the number of bytes to inflate
+ *
+ * @exception std::runtime_error if the IDAT datas are corrupted or truncated
+ */
+void ScanlineDecoder::inflate_to(uint8_t *out, int len)
+{
+    m_stream.next_out = out;
+    m_stream.avail_out = len;
+
+    while (m_stream.avail_out > 0)
+    {
+        if (m_stream.avail_in == 0) // feeding the stream with the next IDAT chunk
+        {
+            if (m_nextData == m_datas.size())
+                throw std::runtime_error("ScanlineDecoder - Truncated IDAT datas");
+
+            m_stream.next_in = const_cast<Bytef *>(m_datas[m_nextData]->data);
+            m_stream.avail_in = m_datas[m_nextData]->length;
+            ++m_nextData;
+            continue;
+        }
+
+        int result = inflate(&m_stream, Z_NO_FLUSH);
+        if (result == Z_STREAM_END && m_stream.avail_out > 0)
+            throw std::runtime_error("ScanlineDecoder - Truncated IDAT datas");
+        if (result != Z_OK && result != Z_STREAM_END)
+            throw std::runtime_error("ScanlineDecoder - Corrupted IDAT datas : " + std::string(m_stream.msg ? m_stream.msg : std::to_string(result)));
+    }
+}
@@ -35,6 +35,31 @@ int Utilities::uint8_to_int(uint8_t *ptr)
     return result;
 }
 
+/**
+ * @brief method for reading a big endian 32 bits value (png byte order), without any allocation
+ *
+ * @param ptr a pointer to the 4 bytes to read
+ * @return the read value
+ */
+uint32_t Utilities::read_be32(const uint8_t *ptr) noexcept
+{
+    return (static_cast<uint32_t>(ptr[0]) << 24) | (static_cast<uint32_t>(ptr[1]) << 16) | (static_cast<uint32_t>(ptr[2]) << 8) | static_cast<uint32_t>(ptr[3]);
+}
+
+/**
+ * @brief writing a 32 bits big endian value (png byte order)
+ *
+ * @param ptr the output, 4 bytes
+ * @param value the value to write
+ */
+void Utilities::write_be32(uint8_t *ptr, uint32_t value) noexcept
+{
+    ptr[0] = static_cast<uint8_t>(value >> 24);
+    ptr[1] = static_cast<uint8_t>(value >> 16);
+    ptr[2] = static_cast<uint8_t>(value >> 8);
+    ptr[3] = static_cast<uint8_t>(value);
+}
+
 /**
  * @brief method for inverting an array of uint8_t
  *
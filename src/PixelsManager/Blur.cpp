@@ -0,0 +1,534 @@
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+#include "../../include/PixelsManager/Blur.h"
+#include "../../include/PixelsManager/PixelsUtilities.h"
+
+namespace
+{
+    constexpr int minBandRows = 32; /**< the minimum number of rows of a band, each band sums its first vertical window again */
+    constexpr float boxSigma = 8.0f; /**< the sigma from which a gaussian blur is approximated by stacked box blurs */
+    constexpr int gaussianBoxes = 3; /**< the number of box blurs approximating a large gaussian blur */
+
+    /**
+     * @brief number of bands of an image, each band has at least minBandRows rows and window rows
+     *
+     * @param height the image height
+     * @param window the height of the vertical window
+     * @param threads the maximum number of threads
+     * @return int the number of bands
+     */
+    inline int bands_count(int height, int window, int threads)
+    {
+        return std::max(1, std::min(threads, height / std::max(minBandRows, window)));
+    }
+
+    /**
+     * @brief rows of a band, the bands have about the same number of rows
+     *
+     * @param height the image height
+     * @param bands the number of bands
+     * @param band the band index
+     * @param firstRow the first row of the band
+     * @param endRow the row following the last row of the band
+     */
+    inline void band_rows(int height, int bands, int band, int &firstRow, int &endRow)
+    {
+        firstRow = static_cast<int>(static_cast<long long>(height) * band / bands);
+        endRow = static_cast<int>(static_cast<long long>(height) * (band + 1) / bands);
+    }
+
+    /**
+     * @brief horizontal running sums of a row : each sum is the sum of the in-bounds samples at most radius pixels away
+     *
+     * @tparam C the number of channels
+     * @param row the row samples
+     * @param sums the output sums, one per sample of the row
+     * @param width the row width, in pixels
+     * @param radius the box radius
+     */
+    template <int C, typename T, typename Acc>
+    void horizontal_sums(const T *row, Acc *sums, int width, int radius)
+    {
+        Acc window[C] = {};
+        for (int x = 0; x <= std::min(radius, width - 1); ++x)
+            for (int c = 0; c < C; ++c)
+                window[c] += row[x * C + c];
+
+        for (int x = 0; x < width; ++x, sums += C)
+        {
+            for (int c = 0; c < C; ++c)
+                sums[c] = window[c];
+
+            const int enter = x + radius + 1, leave = x - radius;
+            if (enter < width)
+                for (int c = 0; c < C; ++c)
+                    window[c] += row[enter * C + c];
+            if (leave >= 0)
+                for (int c = 0; c < C; ++c)
+                    window[c] -= row[leave * C + c];
+        }
+    }
+
+    /**
+     * @brief mean of a box, rounded down or to the nearest for integer samples
+     * @details the division is a multiplication by the inverse of the count, corrected by one when it's not exact.
+     */
+    template <typename T, typename Acc>
+    inline T normalise(Acc sum, Acc count, double inverse, bool rounded)
+    {
+        if constexpr (std::is_floating_point<T>::value)
+            return static_cast<T>(sum * inverse);
+        else
+        {
+            if (rounded)
+                sum += count / 2;
+            Acc quotient = static_cast<Acc>(static_cast<double>(sum) * inverse);
+            if (quotient * count > sum)
+                --quotient;
+            else if ((quotient + 1) * count <= sum)
+                ++quotient;
+            return static_cast<T>(quotient);
+        }
+    }
+
+    /**
+     * @brief box blur of a band of rows
+     * @details the vertical window of each column is a running sum of the horizontal sums of its rows : the horizontal sums
+     * of the entering and leaving rows are computed again instead of being kept, the memory used is 3 rows of sums.
+     *
+     * @tparam C the number of channels
+     * @param image_in the input image
+     * @param image_out the output image, distinct from the input image
+     * @param radius the box radius
+     * @param firstRow the first row of the band
+     * @param endRow the row following the last row of the band
+     * @param countX the number of in-bounds columns of each pixel box
+     * @param inverseX the inverses of countX
+     * @param rounded true for rounding the integer means to the nearest, false for rounding them down
+     * @param sums the band sums, 3 rows of sums
+     */
+    template <int C, typename T, typename Acc>
+    void box_band(const ImageView<const T> &image_in, const ImageView<T> &image_out, int radius, int firstRow, int endRow,
+                  const Acc *countX, const double *inverseX, bool rounded, Acc *sums)
+    {
+        const int width = image_in.width, height = image_in.height;
+        const std::size_t rowSamples = image_in.row_samples();
+        Acc *column = sums, *entering = sums + rowSamples, *leaving = sums + 2 * rowSamples;
+
+        // vertical window of the first row of the band
+        std::fill(column, column + rowSamples, Acc(0));
+        for (int y = std::max(0, firstRow - radius); y <= std::min(height - 1, firstRow + radius); ++y)
+        {
+            horizontal_sums<C>(image_in.row(y), entering, width, radius);
+            for (std::size_t i = 0; i < rowSamples; ++i)
+                column[i] += entering[i];
+        }
+
+        for (int y = firstRow; y < endRow; ++y)
+        {
+            const Acc countY = static_cast<Acc>(std::min(y + radius, height - 1) - std::max(y - radius, 0) + 1);
+            const double inverseY = 1.0 / static_cast<double>(countY);
+            T *out = image_out.row(y);
+            for (int x = 0; x < width; ++x)
+                for (int c = 0; c < C; ++c)
+                    out[x * C + c] = normalise<T>(column[x * C + c], countX[x] * countY, inverseX[x] * inverseY, rounded);
+
+            if (y + 1 == endRow)
+                break;
+
+            // sliding the vertical window to the next row
+            const int enter = y + radius + 1, leave = y - radius;
+            if (enter < height)
+            {
+                horizontal_sums<C>(image_in.row(enter), entering, width, radius);
+                for (std::size_t i = 0; i < rowSamples; ++i)
+                    column[i] += entering[i];
+            }
+            if (leave >= 0)
+            {
+                horizontal_sums<C>(image_in.row(leave), leaving, width, radius);
+                for (std::size_t i = 0; i < rowSamples; ++i)
+                    column[i] -= leaving[i];
+            }
+        }
+    }
+
+    /**
+     * @brief one box blur pass, the bands of rows are blurred in parallel
+     *
+     * @param image_in the input image
+     * @param image_out the output image, distinct from the input image
+     * @param radius the box radius
+     * @param rounded true for rounding the integer means to the nearest, false for rounding them down
+     * @param threads the maximum number of threads
+     */
+    template <typename T, typename Acc>
+    void box_pass(const ImageView<const T> &image_in, const ImageView<T> &image_out, int radius, bool rounded, int threads)
+    {
+        const int width = image_in.width, height = image_in.height;
+        const std::size_t rowSamples = image_in.row_samples();
+
+        std::vector<Acc> countX(width);
+        std::vector<double> inverseX(width);
+        for (int x = 0; x < width; ++x)
+        {
+            countX[x] = static_cast<Acc>(std::min(x + radius, width - 1) - std::max(x - radius, 0) + 1);
+            inverseX[x] = 1.0 / static_cast<double>(countX[x]);
+        }
+
+        const int bands = bands_count(height, 2 * radius + 1, threads);
+        std::vector<Acc> sums(static_cast<std::size_t>(bands) * 3 * rowSamples);
+
+        PixelsUtilities::run_parallel(bands, [&](int band)
+        {
+            int firstRow, endRow;
+            band_rows(height, bands, band, firstRow, endRow);
+            Acc *bandSums = sums.data() + static_cast<std::size_t>(band) * 3 * rowSamples;
+            switch (image_in.channels)
+            {
+                case 1 : box_band<1>(image_in, image_out, radius, firstRow, endRow, countX.data(), inverseX.data(), rounded, bandSums); break;
+                case 2 : box_band<2>(image_in, image_out, radius, firstRow, endRow, countX.data(), inverseX.data(), rounded, bandSums); break;
+                case 3 : box_band<3>(image_in, image_out, radius, firstRow, endRow, countX.data(), inverseX.data(), rounded, bandSums); break;
+                default : box_band<4>(image_in, image_out, radius, firstRow, endRow, countX.data(), inverseX.data(), rounded, bandSums); break;
+            }
+        });
+    }
+
+    /**
+     * @brief input image that the bands can read while the output is written
+     * @details the bands read the rows around them : an input sharing its memory with the output is copied first.
+     *
+     * @param image_in the input image
+     * @param image_out the output image
+     * @param copy the storage of the input copy, only filled if the images share their memory
+     * @return ImageView<const T> the input image, or its copy
+     *
+     * @exception std::bad_alloc if the copy allocation failed
+     */
+    template <typename T>
+    ImageView<const T> unaliased_input(const ImageView<const T> &image_in, const ImageView<T> &image_out, std::vector<T> &copy)
+    {
+        std::less<const T *> before;
+        if (before(image_in.data + image_in.size() - 1, image_out.data) || before(image_out.data + image_out.size() - 1, image_in.data))
+            return image_in;
+
+        const std::size_t rowSamples = image_in.row_samples();
+        copy.resize(rowSamples * image_in.height);
+        for (int y = 0; y < image_in.height; ++y)
+            std::memcpy(copy.data() + y * rowSamples, image_in.row(y), rowSamples * sizeof(T));
+        return ImageView<const T>(copy.data(), image_in.width, image_in.height, image_in.channels);
+    }
+
+    /**
+     * @brief successive box blur passes, of any radii
+     * @details the passes alternate between the output and a temporary image, the last one is written in the output.
+     *
+     * @param image_in the input image, can share its memory with the output image
+     * @param image_out the output image
+     * @param radii the radius of each pass, at least one
+     * @param rounded true for rounding the integer means to the nearest, false for rounding them down
+     * @param threads the maximum number of threads
+     *
+     * @exception std::bad_alloc if the temporary images allocation failed
+     */
+    template <typename T>
+    void box_passes(ImageView<const T> image_in, const ImageView<T> &image_out, const std::vector<int> &radii, bool rounded, int threads)
+    {
+        const std::size_t rowSamples = image_in.row_samples();
+        std::vector<T> copy, temp;
+        image_in = unaliased_input(image_in, image_out, copy);
+
+        const int passes = static_cast<int>(radii.size());
+        if (passes > 1)
+            temp.resize(rowSamples * image_in.height);
+        ImageView<T> tempView(temp.data(), image_in.width, image_in.height, image_in.channels);
+        ImageView<T> target = (passes % 2 == 1) ? image_out : tempView;
+
+        for (int radius : radii)
+        {
+            const uint64_t taps = static_cast<uint64_t>(std::min(2 * radius + 1, image_in.width)) * std::min(2 * radius + 1, image_in.height);
+            if constexpr (std::is_floating_point<T>::value)
+                box_pass<T, double>(image_in, target, radius, rounded, threads);
+            else if (taps * (static_cast<uint64_t>(std::numeric_limits<T>::max()) + 2) <= std::numeric_limits<uint32_t>::max())
+                box_pass<T, uint32_t>(image_in, target, radius, rounded, threads);
+            else
+                box_pass<T, uint64_t>(image_in, target, radius, rounded, threads);
+
+            image_in = target;
+            target = (target.data == image_out.data) ? tempView : image_out;
+        }
+    }
+
+    /**
+     * @brief radii of the box blurs approximating a gaussian blur
+     * @details the boxes widths are the two odd integers around the ideal width, mixed so that the variance of the
+     * stacked boxes is the nearest to sigma².
+     *
+     * @param sigma the gaussian standard deviation
+     * @return std::vector<int> the gaussianBoxes radii
+     */
+    std::vector<int> gaussian_box_radii(float sigma)
+    {
+        const double variance = 12.0 * sigma * sigma, n = gaussianBoxes;
+        int lower = static_cast<int>(std::floor(std::sqrt(variance / n + 1.0)));
+        if (lower % 2 == 0)
+            --lower;
+        const int lowerBoxes = static_cast<int>(std::lround((variance - n * lower * lower - 4.0 * n * lower - 3.0 * n) / (-4.0 * lower - 4.0)));
+
+        std::vector<int> radii(gaussianBoxes);
+        for (int i = 0; i < gaussianBoxes; ++i)
+            radii[i] = (i < lowerBoxes) ? (lower - 1) / 2 : (lower + 1) / 2;
+        return radii;
+    }
+
+    /**
+     * @brief normalised gaussian kernel
+     *
+     * @param sigma the gaussian standard deviation
+     * @param radius the kernel radius
+     * @return std::vector<float> the 2 * radius + 1 weights, their sum is 1
+     */
+    std::vector<float> gaussian_kernel(float sigma, int radius)
+    {
+        std::vector<double> weights(2 * radius + 1);
+        double sum = 0;
+        for (int k = -radius; k <= radius; ++k)
+            sum += weights[k + radius] = std::exp(-static_cast<double>(k) * k / (2.0 * sigma * sigma));
+
+        std::vector<float> kernel(weights.size());
+        for (std::size_t k = 0; k < weights.size(); ++k)
+            kernel[k] = static_cast<float>(weights[k] / sum);
+        return kernel;
+    }
+
+    /**
+     * @brief inverses of the in-bounds kernel weights sums, the kernel is normalised again on the image borders
+     *
+     * @param kernel the normalised kernel
+     * @param radius the kernel radius
+     * @param size the image width or height
+     * @return std::vector<float> the inverse of each position
+     */
+    std::vector<float> border_inverses(const std::vector<float> &kernel, int radius, int size)
+    {
+        std::vector<float> inverses(size, 1.0f);
+        for (int i = 0; i < size; ++i)
+        {
+            if (i >= radius && i + radius < size)
+                continue;
+            double sum = 0;
+            for (int k = std::max(-radius, -i); k <= std::min(radius, size - 1 - i); ++k)
+                sum += kernel[k + radius];
+            inverses[i] = static_cast<float>(1.0 / sum);
+        }
+        return inverses;
+    }
+
+    /**
+     * @brief gaussian blur of a band of rows
+     * @details each row is filtered horizontally once, in a ring of 2 * radius + 1 rows : the rows are converted to floats with
+     * radius zero pixels on each side, so that the taps loops have no bounds checks and are vectorised. The vertical filter
+     * sums the ring rows, the borders are normalised with the inverses of the in-bounds weights. Both filters add the two
+     * samples of a weight before multiplying them, halving the multiplications.
+     *
+     * @tparam C the number of channels
+     * @param image_in the input image
+     * @param image_out the output image, distinct from the input image
+     * @param kernel the normalised kernel
+     * @param radius the kernel radius
+     * @param firstRow the first row of the band
+     * @param endRow the row following the last row of the band
+     * @param inverseX the border inverses of the columns
+     * @param inverseY the border inverses of the rows
+     * @param buffers the band buffers : a padded row, an accumulation row and the ring rows
+     */
+    template <int C, typename T>
+    void gaussian_band(const ImageView<const T> &image_in, const ImageView<T> &image_out, const float *kernel, int radius,
+                       int firstRow, int endRow, const float *inverseX, const float *inverseY, float *buffers)
+    {
+        const int width = image_in.width, height = image_in.height, taps = 2 * radius + 1;
+        const std::size_t rowSamples = image_in.row_samples(), padding = static_cast<std::size_t>(radius) * C;
+        float *padded = buffers, *sums = buffers + rowSamples + 2 * padding, *ring = sums + rowSamples;
+
+        std::fill(padded, padded + rowSamples + 2 * padding, 0.0f);
+        auto filter_row = [&](int y)
+        {
+            const T *row = image_in.row(y);
+            for (std::size_t i = 0; i < rowSamples; ++i)
+                padded[padding + i] = static_cast<float>(row[i]);
+
+            // the kernel is symmetric : the samples at the same distance on each side share their weight
+            float *filtered = ring + static_cast<std::size_t>(y % taps) * rowSamples;
+            const float *center = padded + padding;
+            for (std::size_t i = 0; i < rowSamples; ++i)
+                filtered[i] = kernel[radius] * center[i];
+            for (int k = 1; k <= radius; ++k)
+            {
+                const float weight = kernel[radius + k], *left = center - static_cast<std::size_t>(k) * C, *right = center + static_cast<std::size_t>(k) * C;
+                for (std::size_t i = 0; i < rowSamples; ++i)
+                    filtered[i] += weight * (left[i] + right[i]);
+            }
+            for (int x = 0; x < width; ++x)
+                for (int c = 0; c < C; ++c)
+                    filtered[x * C + c] *= inverseX[x];
+        };
+
+        int nextRow = std::max(0, firstRow - radius);
+        for (int y = firstRow; y < endRow; ++y)
+        {
+            for (; nextRow <= std::min(height - 1, y + radius); ++nextRow)
+                filter_row(nextRow);
+
+            const float *center = ring + static_cast<std::size_t>(y % taps) * rowSamples;
+            for (std::size_t i = 0; i < rowSamples; ++i)
+                sums[i] = kernel[radius] * center[i];
+            for (int k = 1; k <= radius; ++k)
+            {
+                const float weight = kernel[radius + k];
+                const bool up = (y - k >= 0), down = (y + k < height);
+                const float *above = ring + static_cast<std::size_t>((y - k + taps) % taps) * rowSamples;
+                const float *below = ring + static_cast<std::size_t>((y + k) % taps) * rowSamples;
+                if (up && down)
+                    for (std::size_t i = 0; i < rowSamples; ++i)
+                        sums[i] += weight * (above[i] + below[i]);
+                else if (up || down)
+                {
+                    const float *inside = up ? above : below;
+                    for (std::size_t i = 0; i < rowSamples; ++i)
+                        sums[i] += weight * inside[i];
+                }
+            }
+
+            const float inverse = inverseY[y];
+            T *out = image_out.row(y);
+            for (std::size_t i = 0; i < rowSamples; ++i)
+            {
+                if constexpr (std::is_floating_point<T>::value)
+                    out[i] = static_cast<T>(sums[i] * inverse);
+                else
+                    out[i] = static_cast<T>(sums[i] * inverse + 0.5f);
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief box blur, each sample is the mean of the in-bounds samples of the (2 * radius + 1)² box around it
+ * @details the blur is separable : the rows are summed with horizontal running sums, then the columns with vertical running sums,
+ * the cost per pixel doesn't depend on the radius. Boxes are normalised by their number of in-bounds pixels, integer means
+ * are rounded down. The sums are exact : 32 bits integers when the largest box can't overflow them, 64 bits integers otherwise.
+ * Repeated passes approximate a gaussian blur, n passes have the variance of a gaussian of sigma² = n * radius * (radius + 1) / 3.
+ *
+ * @tparam T the sample type : uint8_t, uint16_t or float
+ * @param image_in the input image, 1 to 4 channels
+ * @param image_out the output image, of the same size and channels number. Can be the input image
+ * @param radius the box radius, 0 copies the image
+ * @param passes the number of successive box blurs
+ * @param threads the maximum number of threads, 0 for the number of cpus
+ *
+ * @exception std::invalid_argument if the images don't match or have more than 4 channels, if the radius is negative or the passes number is not positive
+ * @exception std::bad_alloc if the temporary images allocation failed
+ */
+template <typename T>
+void Blur::box(ImageView<const typename ImageView<T>::sample_type> image_in, ImageView<T> image_out, int radius, int passes, int threads)
+{
+    if (image_in.width != image_out.width || image_in.height != image_out.height || image_in.channels != image_out.channels
+        || image_in.channels < 1 || image_in.channels > 4)
+        throw std::invalid_argument("Blur::box() - Invalid images for bluring");
+    if (radius < 0 || passes < 1)
+        throw std::invalid_argument("Blur::box() - Invalid radius or passes number");
+    if (image_in.width <= 0 || image_in.height <= 0)
+        return;
+
+    if (threads <= 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    box_passes(image_in, image_out, std::vector<int>(passes, radius), false, threads);
+}
+
+/**
+ * @brief gaussian blur, each sample is the weighted mean of the in-bounds samples of the (2 * radius + 1)² box around it
+ * @details the gaussian is separable : a normalised 1D kernel is computed once, the rows and then the columns are filtered
+ * with it in float. On the image borders the weights are normalised again by the sum of the in-bounds weights. From a
+ * sigma of 8, with a radius of at least 3 * sigma, the gaussian is approximated by 3 stacked box blurs, whose cost doesn't
+ * depend on sigma. Integer samples are rounded to the nearest.
+ *
+ * @tparam T the sample type : uint8_t, uint16_t or float
+ * @param image_in the input image, 1 to 4 channels
+ * @param image_out the output image, of the same size and channels number. Can be the input image
+ * @param sigma the gaussian standard deviation
+ * @param radius the kernel radius, 0 for 3 * sigma. Limited to 4 * sigma, the weights further are negligible
+ * @param threads the maximum number of threads, 0 for the number of cpus
+ *
+ * @exception std::invalid_argument if the images don't match or have more than 4 channels, if sigma is not positive or the radius is negative
+ * @exception std::bad_alloc if the temporary buffers allocation failed
+ */
+template <typename T>
+void Blur::gaussian(ImageView<const typename ImageView<T>::sample_type> image_in, ImageView<T> image_out, float sigma, int radius, int threads)
+{
+    using Sample = typename ImageView<T>::sample_type;
+
+    if (image_in.width != image_out.width || image_in.height != image_out.height || image_in.channels != image_out.channels
+        || image_in.channels < 1 || image_in.channels > 4)
+        throw std::invalid_argument("Blur::gaussian() - Invalid images for bluring");
+    if (!(sigma > 0) || radius < 0)
+        throw std::invalid_argument("Blur::gaussian() - Invalid sigma or radius");
+    if (image_in.width <= 0 || image_in.height <= 0)
+        return;
+
+    if (threads <= 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    const int maxRadius = static_cast<int>(std::ceil(4.0 * sigma));
+    radius = (radius == 0) ? static_cast<int>(std::ceil(3.0 * sigma)) : std::min(radius, maxRadius);
+
+    if (sigma >= boxSigma && radius >= 3.0 * sigma)
+    {
+        box_passes(image_in, image_out, gaussian_box_radii(sigma), true, threads);
+        return;
+    }
+
+    const int width = image_in.width, height = image_in.height, channels = image_in.channels;
+    const std::size_t rowSamples = image_in.row_samples();
+    std::vector<Sample> copy;
+    image_in = unaliased_input(image_in, image_out, copy);
+
+    const std::vector<float> kernel = gaussian_kernel(sigma, radius);
+    const std::vector<float> inverseX = border_inverses(kernel, radius, width), inverseY = border_inverses(kernel, radius, height);
+
+    const int bands = bands_count(height, 2 * radius + 1, threads);
+    const std::size_t bandFloats = rowSamples * (2 * radius + 3) + 2 * static_cast<std::size_t>(radius) * channels;
+    std::vector<float> buffers(bands * bandFloats);
+
+    PixelsUtilities::run_parallel(bands, [&](int band)
+    {
+        int firstRow, endRow;
+        band_rows(height, bands, band, firstRow, endRow);
+        float *bandBuffers = buffers.data() + band * bandFloats;
+        switch (channels)
+        {
+            case 1 : gaussian_band<1>(image_in, image_out, kernel.data(), radius, firstRow, endRow, inverseX.data(), inverseY.data(), bandBuffers); break;
+            case 2 : gaussian_band<2>(image_in, image_out, kernel.data(), radius, firstRow, endRow, inverseX.data(), inverseY.data(), bandBuffers); break;
+            case 3 : gaussian_band<3>(image_in, image_out, kernel.data(), radius, firstRow, endRow, inverseX.data(), inverseY.data(), bandBuffers); break;
+            default : gaussian_band<4>(image_in, image_out, kernel.data(), radius, firstRow, endRow, inverseX.data(), inverseY.data(), bandBuffers); break;
+        }
+    });
+}
+
+/*
+ * Instantiations : 8 bits, 16 bits (native byte order) and float samples
+ */
+
+template void Blur::box<uint8_t>(ImageView<const uint8_t>, ImageView<uint8_t>, int, int, int);
+template void Blur::box<uint16_t>(ImageView<const uint16_t>, ImageView<uint16_t>, int, int, int);
+template void Blur::box<float>(ImageView<const float>, ImageView<float>, int, int, int);
+
+template void Blur::gaussian<uint8_t>(ImageView<const uint8_t>, ImageView<uint8_t>, float, int, int);
+template void Blur::gaussian<uint16_t>(ImageView<const uint16_t>, ImageView<uint16_t>, float, int, int);
+template void Blur::gaussian<float>(ImageView<const float>, ImageView<float>, float, int, int);
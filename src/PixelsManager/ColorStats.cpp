@@ -0,0 +1,178 @@
+#include <limits>
+#include <algorithm>
+
+#include "../../include/PixelsManager/ColorStats.h"
+
+namespace
+{
+    constexpr std::size_t colorsNumber = std::size_t(1) << 24; /**< the number of 24 bits colors */
+    constexpr std::size_t flatPixels = std::size_t(1) << 20; /**< the pixels number from which the colors are counted in a flat array */
+    constexpr uint32_t emptyKey = 0xFFFFFFFF; /**< the key of an empty slot of the hash table, not a 24 bits color */
+
+    /**
+     * @brief hash a 24 bits key (multiplicative hashing)
+     *
+     * @param key the key
+     * @param bits the number of bits of the slot index
+     * @return uint32_t the slot index
+     */
+    inline uint32_t hash(uint32_t key, int bits) noexcept
+    {
+        return (key * 2654435761u) >> (32 - bits);
+    }
+
+    /**
+     * @brief count the colors in a flat array of 2^24 counters
+     *
+     * @param rgb_in the rgb buffer
+     * @param pixels the number of pixels
+     * @return std::vector<ColorStats::ColorCount> the distinct colors, by increasing keys
+     */
+    std::vector<ColorStats::ColorCount> count_flat(const uint8_t *rgb_in, std::size_t pixels)
+    {
+        std::vector<uint32_t> counters(colorsNumber, 0u);
+        for (std::size_t i = 0; i < pixels; ++i, rgb_in += 3)
+            ++counters[ColorStats::pack(rgb_in)];
+
+        std::vector<ColorStats::ColorCount> colors;
+        for (uint32_t key = 0; key < colorsNumber; ++key)
+            if (counters[key] != 0)
+                colors.push_back({key, counters[key]});
+        return colors;
+    }
+
+    /**
+     * @brief count the colors in an open addressing hash table (linear probing), the table is never more than 1/2 full
+     * @details the table starts small and doubles when it's half full, images with few colors keep it in the cpu caches.
+     * Images have runs of a single color, the hash table is only searched when the color changes.
+     *
+     * @param rgb_in the rgb buffer
+     * @param pixels the number of pixels
+     * @return std::vector<ColorStats::ColorCount> the distinct colors, in the hash table order
+     */
+    std::vector<ColorStats::ColorCount> count_hashed(const uint8_t *rgb_in, std::size_t pixels)
+    {
+        int bits = 12;
+        std::vector<uint32_t> keys(std::size_t(1) << bits, emptyKey), counts(std::size_t(1) << bits, 0u);
+        std::size_t used = 0;
+
+        auto find_slot = [&](uint32_t key) -> uint32_t
+        {
+            const uint32_t mask = (uint32_t(1) << bits) - 1;
+            uint32_t slot = hash(key, bits);
+            while (keys[slot] != key && keys[slot] != emptyKey)
+                slot = (slot + 1) & mask;
+            return slot;
+        };
+
+        uint32_t previous = emptyKey, slot = 0;
+        for (std::size_t i = 0; i < pixels; ++i, rgb_in += 3)
+        {
+            const uint32_t key = ColorStats::pack(rgb_in);
+            if (key != previous)
+            {
+                slot = find_slot(key);
+                if (keys[slot] == emptyKey)
+                {
+                    if (2 * (used + 1) > keys.size())
+                    {
+                        // doubling the table, the colors are inserted again
+                        std::vector<uint32_t> oldKeys(std::size_t(1) << ++bits, emptyKey), oldCounts(std::size_t(1) << bits, 0u);
+                        keys.swap(oldKeys);
+                        counts.swap(oldCounts);
+                        for (std::size_t j = 0; j < oldKeys.size(); ++j)
+                            if (oldKeys[j] != emptyKey)
+                            {
+                                const uint32_t newSlot = find_slot(oldKeys[j]);
+                                keys[newSlot] = oldKeys[j];
+                                counts[newSlot] = oldCounts[j];
+                            }
+                        slot = find_slot(key);
+                    }
+                    keys[slot] = key;
+                    ++used;
+                }
+                previous = key;
+            }
+            ++counts[slot];
+        }
+
+        std::vector<ColorStats::ColorCount> colors;
+        colors.reserve(used);
+        for (std::size_t i = 0; i < keys.size(); ++i)
+            if (keys[i] != emptyKey)
+                colors.push_back({keys[i], counts[i]});
+        return colors;
+    }
+}
+
+
+/**
+ * @brief count the occurrences of each color of a rgb buffer
+ *
+ * @param rgb_in the rgb buffer
+ * @param pixels the number of pixels
+ * @return std::vector<ColorCount> the distinct colors and their occurrences, in no particular order
+ *
+ * @exception std::invalid_argument if the buffer has 2^32 pixels or more
+ * @exception std::bad_alloc if the counters allocation failed
+ */
+std::vector<ColorStats::ColorCount> ColorStats::count(const uint8_t *rgb_in, std::size_t pixels)
+{
+    if (pixels > std::numeric_limits<uint32_t>::max())
+        throw std::invalid_argument("ColorStats::count() - Too many pixels");
+
+    return (pixels >= flatPixels) ? count_flat(rgb_in, pixels) : count_hashed(rgb_in, pixels);
+}
+
+/**
+ * @brief number of distinct colors of a rgb buffer
+ * @details large buffers only set a bit per color, the 2^24 bits fit in the cpu caches.
+ *
+ * @param rgb_in the rgb buffer
+ * @param pixels the number of pixels
+ * @return std::size_t the number of distinct colors
+ *
+ * @exception std::bad_alloc if the counters allocation failed
+ */
+std::size_t ColorStats::distinct(const uint8_t *rgb_in, std::size_t pixels)
+{
+    if (pixels < flatPixels)
+        return count_hashed(rgb_in, pixels).size();
+
+    std::vector<uint64_t> seen(colorsNumber / 64, 0u);
+    for (std::size_t i = 0; i < pixels; ++i, rgb_in += 3)
+    {
+        const uint32_t key = pack(rgb_in);
+        seen[key >> 6] |= uint64_t(1) << (key & 63);
+    }
+
+    std::size_t colors = 0;
+    for (uint64_t word : seen)
+        colors += __builtin_popcountll(word);
+    return colors;
+}
+
+/**
+ * @brief keep the n most frequent colors, by decreasing occurrences
+ * @details the n most frequent colors are selected first (std::nth_element), then only them are sorted. Colors with the
+ * same occurrences are sorted by increasing keys.
+ *
+ * @param colors the colors, resized to n colors
+ * @param n the number of colors to keep, at most the number of colors
+ */
+void ColorStats::most_frequent(std::vector<ColorCount> &colors, std::size_t n)
+{
+    auto more_frequent = [](const ColorCount &a, const ColorCount &b) -> bool
+    {
+        return (a.count != b.count) ? (a.count > b.count) : (a.key < b.key);
+    };
+
+    n = std::min(n, colors.size());
+    if (n < colors.size())
+    {
+        std::nth_element(colors.begin(), colors.begin() + n, colors.end(), more_frequent);
+        colors.resize(n);
+    }
+    std::sort(colors.begin(), colors.end(), more_frequent);
+}
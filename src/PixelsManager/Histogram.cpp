@@ -0,0 +1,248 @@
+#include <thread>
+#include <algorithm>
+
+#include "../../include/PixelsManager/Histogram.h"
+#include "../../include/PixelsManager/PixelsUtilities.h"
+
+namespace
+{
+    constexpr std::size_t minBandSamples = 1 << 18; /**< the minimum number of samples of a band, each band merges its sub-histograms */
+    constexpr int flatRowSamples = 1 << 16; /**< the row length of the views of flat buffers */
+    constexpr uint64_t flushSamples = 1u << 30; /**< the number of pixels after which the 32 bits sub-histograms are merged */
+
+    /**
+     * @brief number of sub-histograms per channel : several for 8 bits samples, they fit in the L1 cache
+     */
+    template <typename T>
+    constexpr int subHistograms = (sizeof(T) == 1) ? 4 : 1;
+
+    /**
+     * @brief add the sub-histograms of a band to its histograms, then clear them
+     *
+     * @tparam C the number of channels
+     * @param sub the sub-histograms, subHistograms<T> groups of C histograms
+     * @param histograms the band histograms, C histograms
+     */
+    template <int C, typename T>
+    void merge_sub(uint32_t *sub, uint64_t *histograms)
+    {
+        constexpr std::size_t bins = C * Histogram::levels<T>;
+        for (int k = 0; k < subHistograms<T>; ++k)
+            for (std::size_t i = 0; i < bins; ++i)
+                histograms[i] += sub[k * bins + i];
+        std::fill(sub, sub + subHistograms<T> * bins, 0u);
+    }
+
+    /**
+     * @brief count the samples of a band of rows
+     * @details consecutive pixels are counted in different sub-histograms. The masked pixels are added with a weight of 0
+     * or 1, the loop has no branch.
+     *
+     * @tparam C the number of channels
+     * @tparam Masked true if the mask is used
+     * @param image the image
+     * @param mask the mask, non-zero for the counted pixels
+     * @param firstRow the first row of the band
+     * @param endRow the row following the last row of the band
+     * @param sub the band sub-histograms, cleared
+     * @param histograms the band histograms, C histograms
+     */
+    template <int C, bool Masked, typename T>
+    void count_band(const ImageView<const T> &image, const ImageView<const uint8_t> &mask, int firstRow, int endRow,
+                    uint32_t *sub, uint64_t *histograms)
+    {
+        constexpr std::size_t L = Histogram::levels<T>;
+        constexpr int K = subHistograms<T>;
+        const int width = image.width;
+
+        uint64_t pending = 0;
+        for (int y = firstRow; y < endRow; ++y)
+        {
+            if (pending + width > flushSamples)
+            {
+                merge_sub<C, T>(sub, histograms);
+                pending = 0;
+            }
+
+            const T *pixels = image.row(y);
+            const uint8_t *masks = Masked ? mask.row(y) : nullptr;
+            int x = 0;
+            for (; x + K <= width; x += K, pixels += K * C)
+                for (int k = 0; k < K; ++k)
+                {
+                    const uint32_t weight = Masked ? (masks[x + k] != 0) : 1;
+                    for (int c = 0; c < C; ++c)
+                        sub[(k * C + c) * L + pixels[k * C + c]] += weight;
+                }
+            for (; x < width; ++x, pixels += C)
+            {
+                const uint32_t weight = Masked ? (masks[x] != 0) : 1;
+                for (int c = 0; c < C; ++c)
+                    sub[c * L + pixels[c]] += weight;
+            }
+            pending += width;
+        }
+        merge_sub<C, T>(sub, histograms);
+    }
+
+    /**
+     * @brief add the histograms of an image, the bands are counted in parallel
+     *
+     * @param image the image, 1 to 4 channels
+     * @param mask the mask, nullptr data for counting all pixels
+     * @param threads the maximum number of threads
+     * @param histograms the image histograms, channels histograms in which the counts are added
+     */
+    template <typename T>
+    void add_histograms(const ImageView<const T> &image, const ImageView<const uint8_t> &mask, int threads, uint64_t *histograms)
+    {
+        if (image.width <= 0 || image.height <= 0)
+            return;
+
+        const std::size_t bins = image.channels * Histogram::levels<T>;
+        const std::size_t samples = image.row_samples() * image.height;
+        const int bands = static_cast<int>(std::max<std::size_t>(1, std::min<std::size_t>({static_cast<std::size_t>(threads),
+                                                                                           samples / minBandSamples,
+                                                                                           static_cast<std::size_t>(image.height)})));
+
+        std::vector<uint32_t> sub(bands * subHistograms<T> * bins, 0u);
+        std::vector<uint64_t> bandHistograms((bands - 1) * bins, 0u); // the first band counts in the output histograms
+        const bool masked = (mask.data != nullptr);
+
+        PixelsUtilities::run_parallel(bands, [&](int band)
+        {
+            const int firstRow = static_cast<int>(static_cast<long long>(image.height) * band / bands);
+            const int endRow = static_cast<int>(static_cast<long long>(image.height) * (band + 1) / bands);
+            uint32_t *bandSub = sub.data() + band * subHistograms<T> * bins;
+            uint64_t *output = (band == 0) ? histograms : bandHistograms.data() + (band - 1) * bins;
+
+            switch (image.channels * 2 + masked)
+            {
+                case 2 : count_band<1, false>(image, mask, firstRow, endRow, bandSub, output); break;
+                case 3 : count_band<1, true>(image, mask, firstRow, endRow, bandSub, output); break;
+                case 4 : count_band<2, false>(image, mask, firstRow, endRow, bandSub, output); break;
+                case 5 : count_band<2, true>(image, mask, firstRow, endRow, bandSub, output); break;
+                case 6 : count_band<3, false>(image, mask, firstRow, endRow, bandSub, output); break;
+                case 7 : count_band<3, true>(image, mask, firstRow, endRow, bandSub, output); break;
+                case 8 : count_band<4, false>(image, mask, firstRow, endRow, bandSub, output); break;
+                default : count_band<4, true>(image, mask, firstRow, endRow, bandSub, output); break;
+            }
+        });
+
+        for (int band = 1; band < bands; ++band)
+            for (std::size_t i = 0; i < bins; ++i)
+                histograms[i] += bandHistograms[(band - 1) * bins + i];
+    }
+
+    /**
+     * @brief maximum number of threads, 0 for the number of cpus
+     */
+    inline int threads_count(int threads)
+    {
+        return (threads > 0) ? threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+}
+
+
+/**
+ * @brief histogram of a buffer of samples
+ * @details the buffer is counted as rows of 65536 samples, followed by the remaining samples.
+ *
+ * @tparam T the sample type : uint8_t or uint16_t
+ * @param samples the samples buffer
+ * @param len the number of samples
+ * @param threads the maximum number of threads, 0 for the number of cpus
+ * @return std::vector<uint64_t> the number of occurrences of each value, levels<T> bins
+ *
+ * @exception std::bad_alloc if the sub-histograms allocation failed
+ */
+template <typename T>
+std::vector<uint64_t> Histogram::compute(const T *samples, std::size_t len, int threads)
+{
+    std::vector<uint64_t> histogram(levels<T>, 0u);
+
+    const std::size_t rows = len / flatRowSamples, tail = len % flatRowSamples;
+    const ImageView<const uint8_t> noMask;
+    for (std::size_t row = 0; row < rows; row += std::numeric_limits<int>::max()) // views heights are int
+    {
+        const int height = static_cast<int>(std::min<std::size_t>(rows - row, std::numeric_limits<int>::max()));
+        add_histograms(ImageView<const T>(samples + row * flatRowSamples, flatRowSamples, height, 1), noMask, threads_count(threads), histogram.data());
+    }
+    add_histograms(ImageView<const T>(samples + rows * flatRowSamples, static_cast<int>(tail), 1, 1), noMask, 1, histogram.data());
+    return histogram;
+}
+
+/**
+ * @brief histograms of the channels of an image, or of a region of an image
+ *
+ * @tparam T the sample type : uint8_t or uint16_t
+ * @param image the image, 1 to 4 channels
+ * @param mask a single channel mask of the image size, only the pixels with a non-zero mask are counted. A null mask counts all pixels
+ * @param threads the maximum number of threads, 0 for the number of cpus
+ * @return std::vector<uint64_t> the histograms of the channels one after the other : the bin of value v of the channel c is c * levels<T> + v
+ *
+ * @exception std::invalid_argument if the image has more than 4 channels, or if the mask doesn't match the image
+ * @exception std::bad_alloc if the sub-histograms allocation failed
+ */
+template <typename T>
+std::vector<uint64_t> Histogram::compute(ImageView<const T> image, ImageView<const uint8_t> mask, int threads)
+{
+    if (image.channels < 1 || image.channels > 4)
+        throw std::invalid_argument("Histogram::compute() - Invalid image channels number");
+    if (mask.data != nullptr && (mask.width != image.width || mask.height != image.height || mask.channels != 1))
+        throw std::invalid_argument("Histogram::compute() - Invalid mask for the image");
+
+    std::vector<uint64_t> histograms(image.channels * levels<T>, 0u);
+    add_histograms(image, mask, threads_count(threads), histograms.data());
+    return histograms;
+}
+
+/**
+ * @brief Otsu Nobuyuki threshold of a histogram, the value maximising the variance between the two classes of values
+ * @note the samples above the threshold are the white class, the others are the black class.
+ *
+ * @param histogram the histogram
+ * @param bins the number of bins of the histogram
+ * @return std::size_t the threshold, 0 for an empty or uniform histogram
+ */
+std::size_t Histogram::otsu_threshold(const uint64_t *histogram, std::size_t bins)
+{
+    double total(0), sum(0), sumB(0), q1(0), q2(0), u1(0), u2(0), var_max(0);
+    std::size_t threshold(0);
+
+    for (std::size_t i = 0; i < bins; i++)
+    {
+        total += histogram[i];
+        sum += static_cast<double>(i) * histogram[i];
+    }
+
+    for (std::size_t i = 0; i < bins; i++) // computing threshold
+    {
+        q1 += histogram[i];
+        if (q1 == 0.0)
+            continue;
+
+        q2 = total - q1;
+        sumB += static_cast<double>(i) * histogram[i];
+        u1 = sumB / q1;
+        u2 = (sum - sumB) / q2;
+
+        const double interClassVariance = (q1 * q2) * (u1 - u2) * (u1 - u2); // setting the interclass variance for the actual sample
+        if (interClassVariance > var_max)
+        {
+            threshold = i;
+            var_max = interClassVariance;
+        }
+    }
+    return threshold;
+}
+
+
+/*
+ * Instantiations : 8 bits and 16 bits (native byte order) samples
+ */
+
+template std::vector<uint64_t> Histogram::compute<uint8_t>(const uint8_t *, std::size_t, int);
+template std::vector<uint64_t> Histogram::compute<uint16_t>(const uint16_t *, std::size_t, int);
+template std::vector<uint64_t> Histogram::compute<uint8_t>(ImageView<const uint8_t>, ImageView<const uint8_t>, int);
+template std::vector<uint64_t> Histogram::compute<uint16_t>(ImageView<const uint16_t>, ImageView<const uint8_t>, int);
@@ -0,0 +1,391 @@
+#include <cmath>
+#include <limits>
+#include <random>
+#include <numeric>
+#include <thread>
+#include <algorithm>
+
+#include "../../include/PixelsManager/KMeans.h"
+#include "../../include/PixelsManager/PixelsUtilities.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define KMEANS_X86_SIMD 1
+#endif
+
+namespace
+{
+    constexpr std::size_t blockPoints = 256; /**< the number of points whose nearest centroids are searched together */
+    constexpr std::size_t minBandPoints = 1 << 14; /**< the minimum number of points of a band, each band has its own sums */
+
+    using assign_kernel = void (*)(const float *x, const float *y, const float *z, std::size_t count, const float *centroids, int clusters,
+                                   int *labels, float *best, float *second);
+
+    /**
+     * @brief search the two nearest centroids of a block of points
+     * @details the centroids are the outer loop : the points loop is branchless and vectorised, the distances of the block
+     * stay in the L1 cache. The body is compiled for each instruction set, see get_assign_kernel.
+     *
+     * @param x the first coordinates of the block points
+     * @param y the second coordinates of the block points
+     * @param z the third coordinates of the block points
+     * @param count the number of points of the block
+     * @param centroids the centroids coordinates
+     * @param clusters the number of centroids
+     * @param labels the nearest centroid of each point
+     * @param best the squared distance of each point to its nearest centroid
+     * @param second the squared distance of each point to its second nearest centroid
+     */
+    __attribute__((always_inline)) inline void assign_block(const float *x, const float *y, const float *z, std::size_t count,
+                                                            const float *centroids, int clusters, int *labels, float *best, float *second)
+    {
+        std::fill(best, best + count, std::numeric_limits<float>::max());
+        std::fill(second, second + count, std::numeric_limits<float>::max());
+        std::fill(labels, labels + count, 0);
+
+        for (int j = 0; j < clusters; ++j)
+        {
+            const float cx = centroids[3 * j], cy = centroids[3 * j + 1], cz = centroids[3 * j + 2];
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const float dx = x[i] - cx, dy = y[i] - cy, dz = z[i] - cz;
+                const float distance = dx * dx + dy * dy + dz * dz;
+                const bool closer = distance < best[i];
+                second[i] = closer ? best[i] : std::min(second[i], distance);
+                best[i] = closer ? distance : best[i];
+                labels[i] = closer ? j : labels[i];
+            }
+        }
+    }
+
+    void assign_block_default(const float *x, const float *y, const float *z, std::size_t count, const float *centroids, int clusters,
+                              int *labels, float *best, float *second)
+    {
+        assign_block(x, y, z, count, centroids, clusters, labels, best, second);
+    }
+
+#ifdef KMEANS_X86_SIMD
+    __attribute__((target("avx2"))) void assign_block_avx2(const float *x, const float *y, const float *z, std::size_t count,
+                                                           const float *centroids, int clusters, int *labels, float *best, float *second)
+    {
+        assign_block(x, y, z, count, centroids, clusters, labels, best, second);
+    }
+#endif
+
+    /**
+     * @brief the assignment kernel of the running cpu
+     */
+    assign_kernel get_assign_kernel() noexcept
+    {
+#ifdef KMEANS_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return assign_block_avx2;
+#endif
+        return assign_block_default;
+    }
+
+    /**
+     * @brief clustering state between two assignments (Hamerly bounds)
+     * @details for each point, upper is at least the distance to its centroid and lower at most the distance to any other
+     * centroid. When centroids move, the bounds are moved by the centroids movements : a point whose upper bound is under
+     * its lower bound, or under half the distance of its centroid to the nearest other centroid, keeps its centroid.
+     */
+    struct Bounds
+    {
+        std::vector<float> upper; /**< the upper bound of the distance of each point to its centroid */
+        std::vector<float> lower; /**< the lower bound of the distance of each point to the other centroids */
+        std::vector<float> movements; /**< the distance moved by each centroid since the last assignment */
+        std::vector<float> halfGaps; /**< half the distance of each centroid to its nearest other centroid */
+        float maxMovement = 0.0f; /**< the maximum of the movements */
+        bool exact = true; /**< true if all the points must be searched, without bounds */
+    };
+
+    /**
+     * @brief assign each point to its nearest centroid, and sum the weighted points of each cluster
+     * @details the points which can have changed of centroid are gathered in blocks, then searched with the assignment kernel.
+     * The bands of points are assigned in parallel, each band sums in its own sums which are added at the end.
+     *
+     * @param points the points
+     * @param threads the maximum number of threads
+     * @param bounds the Hamerly bounds, updated
+     * @param result the clustering : its centroids are read, its labels and weights are written
+     * @param sums the weighted sums of the coordinates of each cluster, followed by the cluster weight
+     */
+    void assign_pass(const KMeans::Points &points, int threads, Bounds &bounds, KMeans::Clustering &result, std::vector<double> &sums)
+    {
+        static const assign_kernel kernel = get_assign_kernel();
+
+        const std::size_t n = points.size();
+        const int clusters = static_cast<int>(result.weights.size());
+        const int bands = static_cast<int>(std::max<std::size_t>(1, std::min<std::size_t>(threads, n / minBandPoints)));
+        std::vector<double> bandSums(bands * 4 * static_cast<std::size_t>(clusters), 0.0);
+        std::vector<float> gathered(bands * 5 * blockPoints);
+        std::vector<int> gatheredLabels(bands * blockPoints);
+        std::vector<std::size_t> gatheredIndices(bands * blockPoints);
+
+        PixelsUtilities::run_parallel(bands, [&](int band)
+        {
+            const std::size_t first = n * band / bands, end = n * (band + 1) / bands;
+            const float *x = points.x.data(), *y = points.y.data(), *z = points.z.data(), *centroids = result.centroids.data();
+            float *gx = gathered.data() + band * 5 * blockPoints, *gy = gx + blockPoints, *gz = gy + blockPoints;
+            float *gBest = gz + blockPoints, *gSecond = gBest + blockPoints;
+            int *gLabels = gatheredLabels.data() + band * blockPoints;
+            std::size_t *gIndices = gatheredIndices.data() + band * blockPoints, count = 0;
+
+            auto search_gathered = [&]()
+            {
+                kernel(gx, gy, gz, count, centroids, clusters, gLabels, gBest, gSecond);
+                for (std::size_t g = 0; g < count; ++g)
+                {
+                    result.labels[gIndices[g]] = gLabels[g];
+                    bounds.upper[gIndices[g]] = std::sqrt(gBest[g]);
+                    bounds.lower[gIndices[g]] = std::sqrt(gSecond[g]);
+                }
+                count = 0;
+            };
+
+            for (std::size_t i = first; i < end; ++i)
+            {
+                if (!bounds.exact)
+                {
+                    const int label = result.labels[i];
+                    float &upper = bounds.upper[i], &lower = bounds.lower[i];
+                    upper += bounds.movements[label];
+                    lower -= bounds.maxMovement;
+
+                    const float bound = std::max(bounds.halfGaps[label], lower);
+                    if (upper <= bound)
+                        continue;
+
+                    const float dx = x[i] - centroids[3 * label], dy = y[i] - centroids[3 * label + 1], dz = z[i] - centroids[3 * label + 2];
+                    upper = std::sqrt(dx * dx + dy * dy + dz * dz);
+                    if (upper <= bound)
+                        continue;
+                }
+
+                gx[count] = x[i];
+                gy[count] = y[i];
+                gz[count] = z[i];
+                gIndices[count] = i;
+                if (++count == blockPoints)
+                    search_gathered();
+            }
+            if (count > 0)
+                search_gathered();
+
+            double *partial = bandSums.data() + band * 4 * static_cast<std::size_t>(clusters);
+            for (std::size_t i = first; i < end; ++i)
+            {
+                double *sum = partial + 4 * result.labels[i];
+                const double weight = points.weights[i];
+                sum[0] += weight * x[i];
+                sum[1] += weight * y[i];
+                sum[2] += weight * z[i];
+                sum[3] += weight;
+            }
+        });
+
+        std::fill(sums.begin(), sums.end(), 0.0);
+        for (int band = 0; band < bands; ++band)
+            for (std::size_t i = 0; i < sums.size(); ++i)
+                sums[i] += bandSums[band * sums.size() + i];
+        for (int j = 0; j < clusters; ++j)
+            result.weights[j] = sums[4 * j + 3];
+        bounds.exact = false;
+    }
+
+    /**
+     * @brief move the centroids to the weighted mean of their points, an empty cluster keeps its centroid
+     *
+     * @param sums the weighted sums of the coordinates of each cluster, followed by the cluster weight
+     * @param centroids the centroids coordinates, updated
+     * @param bounds the Hamerly bounds, their movements and half gaps are updated
+     * @return float the maximum distance moved by a centroid
+     */
+    float move_centroids(const std::vector<double> &sums, std::vector<float> &centroids, Bounds &bounds)
+    {
+        const int clusters = static_cast<int>(bounds.movements.size());
+        bounds.maxMovement = 0.0f;
+        for (int j = 0; j < clusters; ++j)
+        {
+            float *centroid = centroids.data() + 3 * j, movement = 0.0f;
+            if (sums[4 * j + 3] > 0.0)
+                for (int c = 0; c < 3; ++c)
+                {
+                    const float mean = static_cast<float>(sums[4 * j + c] / sums[4 * j + 3]);
+                    movement += (mean - centroid[c]) * (mean - centroid[c]);
+                    centroid[c] = mean;
+                }
+            bounds.movements[j] = std::sqrt(movement);
+            bounds.maxMovement = std::max(bounds.maxMovement, bounds.movements[j]);
+        }
+
+        for (int j = 0; j < clusters; ++j)
+        {
+            float nearest = std::numeric_limits<float>::max();
+            for (int k = 0; k < clusters; ++k)
+            {
+                const float dx = centroids[3 * j] - centroids[3 * k], dy = centroids[3 * j + 1] - centroids[3 * k + 1], dz = centroids[3 * j + 2] - centroids[3 * k + 2];
+                const float distance = dx * dx + dy * dy + dz * dz;
+                nearest = (k != j) ? std::min(nearest, distance) : nearest;
+            }
+            bounds.halfGaps[j] = 0.5f * std::sqrt(nearest);
+        }
+        return bounds.maxMovement;
+    }
+
+    /**
+     * @brief pick a point with a probability proportional to a score
+     * @details the block of the point is searched first with the blocks totals, then the point inside its block.
+     *
+     * @param scores the score of each point
+     * @param blockTotals the sum of the scores of each block of blockPoints points
+     * @param rng the random generator
+     * @return std::size_t the picked point, -1 if all the scores are 0
+     */
+    std::ptrdiff_t pick(const std::vector<float> &scores, const std::vector<double> &blockTotals, std::mt19937 &rng)
+    {
+        const double total = std::accumulate(blockTotals.begin(), blockTotals.end(), 0.0);
+        if (!(total > 0.0))
+            return -1;
+
+        double target = std::uniform_real_distribution<double>(0.0, total)(rng);
+        std::size_t block = 0;
+        while (block + 1 < blockTotals.size() && target >= blockTotals[block])
+            target -= blockTotals[block++];
+
+        // the last point with a positive score of the block, if rounding errors skip all of them
+        std::ptrdiff_t picked = -1;
+        for (std::size_t i = block * blockPoints; i < std::min(scores.size(), (block + 1) * blockPoints); ++i)
+        {
+            if (scores[i] <= 0.0f)
+                continue;
+            picked = static_cast<std::ptrdiff_t>(i);
+            target -= scores[i];
+            if (target < 0.0)
+                break;
+        }
+        return picked;
+    }
+
+    /**
+     * @brief k-means++ seeding : each new centroid is a point picked with a probability proportional to its weight times its
+     * squared distance to the nearest centroid already chosen
+     * @details when there are fewer distinct points than clusters, the last centroids are copies of the first one, their
+     * clusters stay empty.
+     *
+     * @param points the points, at least one
+     * @param clusters the number of centroids
+     * @param rng the random generator
+     * @return std::vector<float> the centroids coordinates
+     */
+    std::vector<float> seed_centroids(const KMeans::Points &points, int clusters, std::mt19937 &rng)
+    {
+        const std::size_t n = points.size(), blocks = (n + blockPoints - 1) / blockPoints;
+        const float *x = points.x.data(), *y = points.y.data(), *z = points.z.data();
+        std::vector<float> centroids, distances(n, std::numeric_limits<float>::max()), scores(points.weights);
+        std::vector<double> blockTotals(blocks, 0.0);
+
+        for (std::size_t block = 0; block < blocks; ++block)
+            for (std::size_t i = block * blockPoints; i < std::min(n, (block + 1) * blockPoints); ++i)
+                blockTotals[block] += scores[i];
+
+        std::ptrdiff_t chosen = pick(scores, blockTotals, rng);
+        if (chosen < 0) // no weights, the first point
+            chosen = 0;
+        for (int j = 0; j < clusters; ++j)
+        {
+            const float cx = x[chosen], cy = y[chosen], cz = z[chosen];
+            centroids.insert(centroids.end(), {cx, cy, cz});
+            if (j + 1 == clusters)
+                break;
+
+            for (std::size_t block = 0; block < blocks; ++block)
+            {
+                float total = 0.0f;
+                for (std::size_t i = block * blockPoints; i < std::min(n, (block + 1) * blockPoints); ++i)
+                {
+                    const float dx = x[i] - cx, dy = y[i] - cy, dz = z[i] - cz;
+                    distances[i] = std::min(distances[i], dx * dx + dy * dy + dz * dz);
+                    scores[i] = points.weights[i] * distances[i];
+                    total += scores[i];
+                }
+                blockTotals[block] = total;
+            }
+
+            chosen = pick(scores, blockTotals, rng);
+            if (chosen < 0)
+            {
+                for (int k = j + 1; k < clusters; ++k)
+                    centroids.insert(centroids.end(), {centroids[0], centroids[1], centroids[2]});
+                break;
+            }
+        }
+        return centroids;
+    }
+}
+
+
+/**
+ * @brief k-means clustering of weighted points
+ * @details the centroids are seeded with k-means++, then each iteration moves each centroid to the weighted mean of its
+ * points and assigns the points to their nearest centroid. The iterations stop when no centroid moved more than the
+ * tolerance, or after iters iterations. An empty cluster keeps its centroid. The labels, distances and weights of the
+ * result are the ones of the returned centroids.
+ *
+ * @param points the points and their weights
+ * @param clusters the number of clusters
+ * @param iters the maximum number of iterations
+ * @param tolerance the distance under which a centroid is considered as not moving
+ * @param threads the maximum number of threads, 0 for the number of cpus
+ * @param seed the seed of the random generator, the same seed gives the same clustering
+ * @return Clustering the centroids, the clusters weights and the cluster of each point
+ *
+ * @exception std::invalid_argument if there are no points, or if the clusters number is not positive or the iterations number negative
+ * @exception std::bad_alloc if the clustering allocation failed
+ */
+KMeans::Clustering KMeans::cluster(const Points &points, int clusters, int iters, float tolerance, int threads, uint32_t seed)
+{
+    const std::size_t n = points.size();
+    if (n == 0 || points.y.size() != n || points.z.size() != n || points.weights.size() != n)
+        throw std::invalid_argument("KMeans::cluster() - Invalid points");
+    if (clusters < 1 || iters < 0)
+        throw std::invalid_argument("KMeans::cluster() - Invalid clusters or iterations number");
+
+    if (threads <= 0)
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    Clustering result;
+    result.labels.resize(n);
+    result.weights.resize(clusters);
+
+    std::mt19937 rng(seed);
+    result.centroids = seed_centroids(points, clusters, rng);
+
+    Bounds bounds;
+    bounds.upper.resize(n);
+    bounds.lower.resize(n);
+    bounds.movements.resize(clusters);
+    bounds.halfGaps.resize(clusters);
+
+    std::vector<double> sums(4 * static_cast<std::size_t>(clusters));
+    assign_pass(points, threads, bounds, result, sums);
+    while (result.iterations < iters)
+    {
+        const float moved = move_centroids(sums, result.centroids, bounds);
+        ++result.iterations;
+
+        assign_pass(points, threads, bounds, result, sums);
+        if (moved <= tolerance)
+            break;
+    }
+
+    result.distances.resize(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const float *centroid = result.centroids.data() + 3 * result.labels[i];
+        const float dx = points.x[i] - centroid[0], dy = points.y[i] - centroid[1], dz = points.z[i] - centroid[2];
+        result.distances[i] = dx * dx + dy * dy + dz * dz;
+    }
+    return result;
+}
@@ -2,6 +2,17 @@
 #include "../../include/PNG/Utilities.h"
 #include "../../include/PixelsManager/PixelsManager.h"
 #include "../../include/PixelsManager/PixelsUtilities.h"
+#include "../../include/PixelsManager/Blur.h"
+#include "../../include/PixelsManager/Histogram.h"
+#include "../../include/PixelsManager/ColorStats.h"
+#include "../../include/PixelsManager/KMeans.h"
+
+namespace
+{
+    // sums of samples : exact integers for the integer samples, double for the float samples
+    template <typename T>
+    using accumulator_t = std::conditional_t<std::is_floating_point<T>::value, double, long long>;
+}
 
 /**
  * @brief converting a rgb input buffer to a grayscale buffer
@@ -9,52 +20,82 @@
  * @details it consit for each pixel sample(red-green-blue) to determine the luminance value.
  * in the output, every rgb value should replaced by the related luminance value.
  *
+ * @tparam T the sample type : uint8_t, uint16_t (native byte order) or float
  * @param rgb_in the rgb input buffer
- * @param rgb_len the rgb buffer size
+ * @param rgb_len the rgb buffer size, in samples
  * @param mode indicate how the grayscale ouput should be, each mode implement a different luminace value calculation
  * @param gray_len a reference to the grayscale buffer ouptut size
  *
- * @return uint8_t* output converted grayscale buffer
+ * @return T* output converted grayscale buffer
  * @exception std::invalid_argument case none of the avaible gray convertion mode selected
  * @exception std::bad_alloc case the output buffer memory allocation failed
  * @see PixelsManager::gray_level
  */
-uint8_t *PixelsManager::rgb_to_grayscale(const uint8_t *rgb_in, int rgb_len, int mode, int &gray_len)
+template <typename T>
+T *PixelsManager::rgb_to_grayscale(const T *rgb_in, int rgb_len, int mode, int &gray_len)
 {
-    uint8_t *grayscaleBuffer = new uint8_t[(gray_len = (rgb_len / 3))]; // output buffer
+    T *grayscaleBuffer = new T[(gray_len = (rgb_len / 3))]; // output buffer
     if (!grayscaleBuffer)
         throw std::bad_alloc();
 
+    try
+    {
+        PixelsManager::rgb_to_grayscale(ImageView<const T>(rgb_in, gray_len, 1, 3), ImageView<T>(grayscaleBuffer, gray_len, 1, 1), mode);
+    }
+    catch (const std::exception &)
+    {
+        delete[] grayscaleBuffer;
+        throw;
+    }
+    return grayscaleBuffer;
+}
+
+/**
+ * @brief converting a rgb image to a grayscale image
+ * @details same conversion as the buffer version, the images rows can be padded and the rgb image can have an alpha channel.
+ *
+ * @tparam T the sample type : uint8_t, uint16_t (native byte order) or float
+ * @param rgb_in the rgb(a) input image, 3 or 4 channels
+ * @param gray_out the grayscale output image, of the same size with a single channel
+ * @param mode indicate how the grayscale ouput should be, each mode implement a different luminace value calculation
+ *
+ * @exception std::invalid_argument case none of the avaible gray convertion mode selected, or if the images don't match
+ * @see PixelsManager::gray_level
+ */
+template <typename T>
+void PixelsManager::rgb_to_grayscale(ImageView<const typename ImageView<T>::sample_type> rgb_in, ImageView<T> gray_out, int mode)
+{
+    if (rgb_in.channels < 3 || rgb_in.channels > 4 || gray_out.channels != 1 || rgb_in.width != gray_out.width || rgb_in.height != gray_out.height)
+        throw std::invalid_argument("Invalid images for grayscale convertion");
+
+    // applying the luminance computing of the mode on each pixel
+    auto convert = [&](auto luminance)
+    {
+        for (int y = 0; y < rgb_in.height; ++y)
+        {
+            const T *pixel = rgb_in.row(y);
+            T *gray = gray_out.row(y);
+            for (int x = 0; x < rgb_in.width; ++x, pixel += rgb_in.channels)
+                gray[x] = static_cast<T>(luminance(pixel));
+        }
+    };
+
     switch (mode) // each mode perform a different grayscale computing method
     {
     case gray_level::AVERAGE:
-        for (std::size_t i = 0, j = 0; i < rgb_len; i += 3, j++)
-            grayscaleBuffer[j] = (rgb_in[i] + rgb_in[i] + rgb_in[i + 2]) / 3;
-
-        return grayscaleBuffer;
+        convert([](const T *rgb) { return (rgb[0] + rgb[0] + rgb[2]) / 3; });
         break;
 
     case gray_level::BRIGHTER:
-        for (std::size_t i = 0, j = 0; i < rgb_len; i += 3, j++)
-            grayscaleBuffer[j] = floor((getMax(rgb_in[i], rgb_in[i], rgb_in[i + 2]) +
-                                        getMin(rgb_in[i], rgb_in[i], rgb_in[i + 2])) /
-                                       2);
-
-        return grayscaleBuffer;
+        convert([](const T *rgb) { return floor((getMax(rgb[0], rgb[0], rgb[2]) + getMin(rgb[0], rgb[0], rgb[2])) / 2); });
         break;
 
     case gray_level::LIGHTER:
-        for (std::size_t i = 0, j = 0; i < rgb_len; i += 3, j++)
-            grayscaleBuffer[j] = rgb_in[i] * 0.21 + rgb_in[i] * 0.71 + rgb_in[i + 2] * 0.07;
-
-        return grayscaleBuffer;
+        convert([](const T *rgb) { return rgb[0] * 0.21 + rgb[0] * 0.71 + rgb[2] * 0.07; });
         break;
 
     case gray_level::DEFAULT:
-        for (std::size_t i = 0, j = 0; i < rgb_len; i += 3, j++)
-            grayscaleBuffer[j] = rgb_in[i] * 0.299 + rgb_in[i] * 0.587 + rgb_in[i + 2] * 0.114;
-
-        return grayscaleBuffer;
+        convert([](const T *rgb) { return rgb[0] * 0.299 + rgb[0] * 0.587 + rgb[2] * 0.114; });
         break;
 
     default:
@@ -163,60 +204,36 @@ uint8_t *PixelsManager::rgb_to_channel_s(const uint8_t *rgb_in, int rgb_len, int
  * @note Implementation of the Otsu Nobuyuki binarisation method -see on wikipedia-
  * according to experience result, binarisation method works better on a grayscale image.
  * then this is only working with a grayscale input.
+ * @tparam T the sample type : uint8_t (256 levels) or uint16_t (65536 levels, native byte order)
  * @param gray_in the grayscale input buffer
  * @param gray_len the grayscale input buffer size
  * @param bin_len a reference to the otsu binarised buffer size
  *
- * @return uint8_t* output binarised buffer
+ * @return T* output binarised buffer, samples are 0 or the maximum level
  *
  * @exception std::bad_alloc case the output buffer memory allocation failed
  */
-uint8_t *PixelsManager::grayscale_to_otsu(const uint8_t *gray_in, int gray_len, int &bin_len)
+template <typename T>
+T *PixelsManager::grayscale_to_otsu(const T *gray_in, int gray_len, int &bin_len)
 {
-    double threshold(0), var_max(0), sum(0), sumB(0), q1(0), q2(0), u1(0), u2(0);
-    double interClassVariance(0);
+    static_assert(std::is_integral<T>::value, "Otsu binarisation needs integer samples");
 
-    int binariseLen = gray_len;                                     // output binarised buffer size
-    uint8_t *binariseBuffer = new uint8_t[(bin_len = binariseLen)]; // output buffer
+    int binariseLen = gray_len;                         // output binarised buffer size
+    T *binariseBuffer = new T[(bin_len = binariseLen)]; // output buffer
     if (!binariseBuffer)
         throw std::bad_alloc();
 
-    // generating histogram
-    std::vector<unsigned long> histogram;
-    for (std::size_t i = 0; i <= 255; i++)
-        histogram.push_back(std::count(gray_in, gray_in + gray_len, i));
-
-    for (std::size_t i = 0; i <= 255; i++)
-        sum += i * histogram[i];
-
-    for (std::size_t i = 0; i <= 255; i++) // computing threshold
-    {
-        q1 += histogram[i];
-        if (q1 == 0.0)
-            continue;
-
-        q2 = binariseLen - q1;
-        sumB += i * histogram[i];
-        u1 = sumB / q1;
-        u2 = (sum - sumB) / q2;
-
-        interClassVariance = (q1 * q2) * pow((u1 - u2), 2.0); // setting the interclass variance for the actual sample
-
-        if (interClassVariance > var_max) // , we affect the threshold
-        {
-            threshold = i;
-            var_max = interClassVariance;
-        }
-    }
+    // generating histogram, in a single pass over the buffer, then computing threshold
+    const std::vector<uint64_t> histogram{Histogram::compute(gray_in, gray_len)};
+    const std::size_t threshold = Histogram::otsu_threshold(histogram.data(), histogram.size());
 
     for (std::size_t i = 0; i < binariseLen; i++)
     {
-        if (gray_in[i] > threshold) // 255 = total white
-            binariseBuffer[i] = 255;
+        if (gray_in[i] > threshold) // maximum level = total white
+            binariseBuffer[i] = std::numeric_limits<T>::max();
         else
             binariseBuffer[i] = 0; // 0 = total black
     }
-    histogram.clear();
     return binariseBuffer; // return the binarised buffer
 }
 
@@ -452,78 +469,53 @@ uint8_t *PixelsManager::lut_to_rgb_thread(const uint8_t *gray_in, int gray_len,
 
 /**
  * @brief Method for getting the histogram for an input buffer
+ * @see Histogram::compute
  *
  * @param gray_in the input grayscale buffer
  * @param gray_len the input buffer size
  * @return vector<int> representing the histogram output.
  * @note the method return the number of occurrences for values from 0 to 255.
+ *
+ * @exception std::bad_alloc if the histogram allocation failed
  */
-std::vector<int> PixelsManager::getHistogram(const uint8_t *buffer_in, int buffer_len) noexcept
+std::vector<int> PixelsManager::getHistogram(const uint8_t *buffer_in, int buffer_len)
 {
-    std::vector<int> histogram;
-    for (std::size_t i = 0; i <= 255; i++)
-        histogram.push_back(std::count(buffer_in, buffer_in + buffer_len, i));
-    return histogram;
+    const std::vector<uint64_t> counts{Histogram::compute(buffer_in, buffer_len)};
+    return std::vector<int>(counts.begin(), counts.end());
 }
 
 /**
  * @brief method for getting a fix number of colors that are most repetitives from an input rgb buffer
+ * @see ColorStats::count
  *
  * @param rgb_in the input rgb buffer
  * @param rgb_len the rgb buffer size
  * @param nb_colors_out the wanted number of color in the output
  *
- * @return a buffer containing the number of desired colors or nullptr if error occurred
+ * @return a buffer containing the number of desired colors, from highest to fewest occurrences number
  * @exception std::bad_alloc case output buffer memory allocation failed
  * @exception std::runtime_error case wanted color number is greater than avaibles
  */
 uint8_t *PixelsManager::get_high_occ_colors(const uint8_t *rgb_in, int rgb_len, int nb_colors_out)
 {
-    using rgb_color = std::tuple<uint8_t, uint8_t, uint8_t>;
-
-    // convertying the input rgb buffer into a buffer of 3-tuple <R,G,B>
-    rgb_color *rgb_arr = new rgb_color[(rgb_len / 3)];
-
-    if (!rgb_arr)
-        throw std::bad_alloc();
-
-    for (std::size_t i = 0, j = 0; i < (rgb_len / 3); ++i, j += 3)
-        rgb_arr[i] = std::make_tuple(rgb_in[j], rgb_in[j + 1], rgb_in[j + 2]);
-
-    // calculate the number of occurrences of each rgb tuple
-    std::map<rgb_color, int> occ;
-    for (std::size_t i = 0; i < (rgb_len / 3); ++i)
-        ++occ[rgb_arr[i]];
-
-    const int color_number{(int)occ.size()};
-    if (nb_colors_out > color_number)
+    // calculate the number of occurrences of each color, then select the most repetitives ones
+    std::vector<ColorStats::ColorCount> colors{ColorStats::count(rgb_in, rgb_len / 3)};
+    if (nb_colors_out > static_cast<int>(colors.size()))
         throw std::runtime_error("Wanted dominants colors is grater than avaible colors");
-
-    // unfortunately, maps stores values by sorting by key(rgb tuple), but we want sorting by occurrences
-    // then we'll put each rgb-tuple and occurrences, stores it in a vector of pairs, and sort vector by occurrences
-    std::vector<std::pair<rgb_color, int>> vec;
-    std::copy(occ.begin(), occ.end(), std::back_inserter<std::vector<std::pair<rgb_color, int>>>(vec));
-    sort(vec.begin(), vec.end(), [](const std::pair<rgb_color, int> &a, const std::pair<rgb_color, int> &b) -> bool
-                                 {
-                                    return (a.second > b.second); // sorting by decreasing occurrences number
-                                 });
+    ColorStats::most_frequent(colors, nb_colors_out);
 
     uint8_t *out_buffer = new uint8_t[nb_colors_out * 3]; // output buffer
     if (!out_buffer)
         throw std::bad_alloc();
 
-    for (std::size_t i = 0, j = 0; i < nb_colors_out; i++, j += 3) // copying dominants colors in the output buffer
-        std::tie(out_buffer[j], out_buffer[j + 1], out_buffer[j + 2]) = vec[i].first;
-
-    delete[] rgb_arr;
-    occ.clear();
-    vec.clear();
-
+    for (std::size_t i = 0; i < nb_colors_out; i++) // copying dominants colors in the output buffer
+        ColorStats::unpack(colors[i].key, out_buffer + 3 * i);
     return out_buffer;
 }
 
 /**
  * @brief method for getting the nmber of color inside an input rgb buffer
+ * @see ColorStats::distinct
  *
  * @param rgb_in input rgb buffer
  * @param rgb_len rgb buffer size
@@ -533,25 +525,7 @@ uint8_t *PixelsManager::get_high_occ_colors(const uint8_t *rgb_in, int rgb_len,
  */
 int PixelsManager::get_nb_colors(const uint8_t *rgb_in, int rgb_len)
 {
-    using rgb_color = std::tuple<uint8_t, uint8_t, uint8_t>;
-
-    // convertying the input rgb buffer into a buffer of 3-tuple <R,G,B>
-    rgb_color *rgb_arr = new rgb_color[(rgb_len / 3)];
-
-    if (!rgb_arr)
-        throw std::bad_alloc();
-
-    for (std::size_t i = 0, j = 0; i < (rgb_len / 3); ++i, j += 3)
-        rgb_arr[i] = std::make_tuple(rgb_in[j], rgb_in[j + 1], rgb_in[j + 2]);
-
-    // calculate the number of occurrences of each rgb tuple
-    std::map<rgb_color, int> occ;
-    for (std::size_t i = 0; i < (rgb_len / 3); ++i)
-        ++occ[rgb_arr[i]];
-
-    delete[] rgb_arr;
-
-    return occ.size();
+    return static_cast<int>(ColorStats::distinct(rgb_in, rgb_len / 3));
 }
 
 /**
@@ -677,69 +651,54 @@ uint8_t *PixelsManager::hsl_to_rgb(const double *hsl_in, int hsl_len)
 
 /**
  * @brief method for getting most dominants colors in an image, by kmean clustering algorithm implementation.
+ * @details the distinct colors are clustered once each, weighted by their number of occurrences. The dominant color of a
+ * cluster is its color with the highest occurrences number.
+ * @see KMeans::cluster
  * 
  * @param rgb_in input rgb buffer
  * @param rgb_len input rgb buffer size
  * @param nb_colors wanted dominants color number
- * @param iters number of ietrations for kmean clustering
+ * @param iters maximum number of iterations for kmean clustering
  * @param nb_colors_out effective colors out
  * @note nb_colors_out will contain the effective colors in the output buffer, cause after kmean computes specified iterations, it can be a cluster
  * which is empty (has no elements). 
- * @warning because input cluster positions are generated randomly, this method doesn't guarantee the same result at each execution.
+ * @note the clusters are seeded with k-means++ from a fixed seed, the same input gives the same result.
  * 
  * @return uint8_t* output buffer of the effective dominants colors.
  * @exception std::runtime_error if wanted numbers of colors are greater than avaible colors.
+ * @exception std::invalid_argument if the wanted numbers of colors is not positive.
  */
 uint8_t *PixelsManager::get_dominants_colors_kmean(const uint8_t *rgb_in, int rgb_len, int nb_colors, int iters, int &nb_colors_out)
 {   
-    //for avoinding repetitions of colors when computing, we firstly extract colors in rgb input buffer(no repetitions) 
-    int total_colors_nb = PixelsManager::get_nb_colors(rgb_in, rgb_len);
-    uint8_t *rgb_buffer = PixelsManager::get_high_occ_colors(rgb_in, rgb_len, total_colors_nb); //grtting all colors without redundance
-
-    // start by convertying input rgb buffer to points for kmean clustering
-    std::vector<PixelsUtilities::Kmean_point> colors;
-    for(int i = 0; i < total_colors_nb * 3; i += 3)
-        colors.emplace_back(PixelsUtilities::Kmean_point(rgb_buffer[i], rgb_buffer[i + 1], rgb_buffer[i + 2]));
-
-    // kmean clustering method, note that this method only modify the points buffer, precisely the cluster id of each point
-    PixelsUtilities::kMeansClustering(colors, iters, nb_colors);
-
-    // converting points buffer into a map, key = cluster ID, value = list of colors inside the actual cluster. 
-    std::map<int, std::vector<std::tuple<uint8_t, uint8_t, uint8_t>>> clusterID_colors;
-    for(int i = 0; i < nb_colors; ++i)
-        for(std::size_t j = 0; j < colors.size(); ++j)
-            if(colors[j].cluster == i)
-                clusterID_colors[i].emplace_back(std::make_tuple(colors[j].r, colors[j].g, colors[j].b));
-
-    int inc = 0;
-    nb_colors_out = 0;
-    uint8_t *rgb_out = new uint8_t[nb_colors * 3]; // output 
-
-    if(nb_colors > total_colors_nb)
+    //for avoinding repetitions of colors when computing, we firstly extract colors in rgb input buffer(no repetitions), with their occurrences
+    const std::vector<ColorStats::ColorCount> counts{ColorStats::count(rgb_in, rgb_len / 3)};
+    if(nb_colors > static_cast<int>(counts.size()))
         throw(std::runtime_error("Wanted numbers of colors are greater than avaible colors"));
 
-    // Note : PixelsManager::get_high_occ_colors returns a rgb buffer in which rgb's are stored from highest to fewest occurrences number.
-    // for each cluster, we search in the paired color list the first which match the rgb buffer, in which in which rgb's are stored from highest to fewest occurrences number.
-    // after finding a match, we skip and search again in the next cluster, so that we'll end up with colors with highest occurrences of each clusters.
-    for(auto &id_color_pair : clusterID_colors)
+    // start by convertying the colors to weighted points for kmean clustering
+    KMeans::Points colors;
+    for(const auto &color : counts)
     {
-        for (std::size_t j = 0; j < total_colors_nb * 3; j += 3)
-        {
-            auto color_tofind = std::make_tuple(rgb_buffer[j], rgb_buffer[j + 1], rgb_buffer[j + 2]);
-            auto found = std::find(id_color_pair.second.begin(), id_color_pair.second.end(), color_tofind);
+        uint8_t rgb[3];
+        ColorStats::unpack(color.key, rgb);
+        colors.push_back(rgb[0], rgb[1], rgb[2], static_cast<float>(color.count));
+    }
+    const KMeans::Clustering clustering{KMeans::cluster(colors, nb_colors, iters)};
 
-            if (found == id_color_pair.second.end())
-                continue;
-            else
-            {
-                std::tie(rgb_out[inc], rgb_out[inc + 1], rgb_out[inc + 2]) = *found;
-                ++nb_colors_out;
-                break;
-            }
-        }
+    // for each cluster, the color with the highest occurrences (the lowest key between equal occurrences)
+    std::vector<int> dominants(nb_colors, -1);
+    for(std::size_t i = 0; i < counts.size(); ++i)
+    {
+        int &dominant = dominants[clustering.labels[i]];
+        if(dominant < 0 || counts[i].count > counts[dominant].count || (counts[i].count == counts[dominant].count && counts[i].key < counts[dominant].key))
+            dominant = static_cast<int>(i);
     }
-    delete[] rgb_buffer; 
 
+    nb_colors_out = 0;
+    uint8_t *rgb_out = new uint8_t[nb_colors * 3]; // output 
+    for(int dominant : dominants)
+        if(dominant >= 0)
+            ColorStats::unpack(counts[dominant].key, rgb_out + 3 * nb_colors_out++);
     return rgb_out;
 }
 
@@ -789,109 +748,140 @@ uint8_t *PixelsManager::overscreen_color(const uint8_t *rgb_in, int rgb_len, con
 
 /**
  * @brief Method for bluring an input rgb buffer
- * @details Method based on default neighbours mean
- *  
+ * @details Method based on default neighbours mean, computed with running sums (Blur::box) : the time doesn't depend on the radius.
+ * @see Blur::box
+ *
+ * @tparam T the sample type : uint8_t, uint16_t (native byte order) or float
  * @param rgb_in the input rgb buffer
  * @param rgb_len input rgb buffer size
  * @param width the width of the rgb buffer
  * @param height the height of the rgb buffer
  * @param side_neigbours number of neighbours to use.
- * @note side_neighbours indicates the radius in which neighbours wi'll be took. 
- * 
+ * @param passes the number of successive blurs, 3 passes approximate a gaussian blur
+ * @note side_neighbours indicates the radius in which neighbours wi'll be took.
+ *
  * @exception std::bad_alloc if output memory allocation failed
- * @return uint8_t* the blurred buffer
+ * @return T* the blurred buffer
  */
-uint8_t *PixelsManager::blur(const uint8_t *rgb_in, int rgb_len, int s_width, int s_height, int side_neigbours)
+template <typename T>
+T *PixelsManager::blur(const T *rgb_in, int rgb_len, int s_width, int s_height, int side_neigbours, int passes)
 {
-    uint8_t *blur_out = new uint8_t[s_width * s_height * 3]; // output buffer
+    T *blur_out = new T[s_width * s_height * 3]; // output buffer
     if(!blur_out)
         throw std::bad_alloc();
 
-    for(int i = 0; i < s_height; ++i)
+    try
     {
-        for(int j = 0; j < s_width; ++j)
-        {
-            int s_r = 0, s_g = 0, s_b = 0, inc = 0;
-            for(int k = -side_neigbours; k <= side_neigbours; ++k)
-            {
-                for(int l = -side_neigbours; l <= side_neigbours; ++l)
-                {
-                    if (i + k < 0 || i + k >= s_height)
-                        continue;
-                    if (j + l < 0 || j + l >= s_width)
-                        continue;   
-                    
-                    s_r += rgb_in[((i + k) * s_width * 3) + ((j + l) * 3)];
-                    s_g += rgb_in[((i + k) * s_width * 3) + ((j + l) * 3) + 1];
-                    s_b += rgb_in[((i + k) * s_width * 3) + ((j + l) * 3) + 2];
-                    ++inc;
-                }
-            }
-
-            blur_out[(i * s_width * 3) + (j * 3)] =  s_r / inc;       
-            blur_out[(i * s_width * 3) + (j * 3) + 1] = s_g / inc;       
-            blur_out[(i * s_width * 3) + (j * 3) + 2] = s_b / inc;       
-        }
+        Blur::box(ImageView<const T>(rgb_in, s_width, s_height, 3), ImageView<T>(blur_out, s_width, s_height, 3), side_neigbours, passes);
     }
-
-    return blur_out; 
+    catch (const std::exception &)
+    {
+        delete[] blur_out;
+        throw;
+    }
+    return blur_out;
 }
 
+/**
+ * @brief Method for bluring an input image
+ * @details same neighbours mean as the buffer version, for images of 1 to 4 channels with padded rows.
+ * @see Blur::box
+ *
+ * @tparam T the sample type : uint8_t, uint16_t (native byte order) or float
+ * @param image_in the input image
+ * @param image_out the blurred output image, of the same size and channels number
+ * @param side_neigbours number of neighbours to use.
+ * @param passes the number of successive blurs, 3 passes approximate a gaussian blur
+ *
+ * @exception std::invalid_argument if the images don't match, or have more than 4 channels
+ */
+template <typename T>
+void PixelsManager::blur(ImageView<const typename ImageView<T>::sample_type> image_in, ImageView<T> image_out, int side_neigbours, int passes)
+{
+    Blur::box(image_in, image_out, side_neigbours, passes);
+}
 
 /**
  * @brief Method for bluring an input rgb buffer
- * @details A non-linear, edge-preserving, and noise-reducing smoothing filter for images. 
- * It replaces the intensity of each pixel with a weighted average of intensity values from nearby pixels. 
- * This weight is based on a Gaussian distribution.
- *  
+ * @details It replaces the intensity of each pixel with a weighted average of intensity values from nearby pixels.
+ * This weight is based on a Gaussian distribution of the distance.
+ * @see Blur::gaussian
+ *
+ * @tparam T the sample type : uint8_t, uint16_t (native byte order) or float
  * @param rgb_in the input rgb buffer
  * @param rgb_len input rgb buffer size
  * @param width the width of the rgb buffer
  * @param height the height of the rgb buffer
- * @param side_neigbours number of neighbours to use.
+ * @param side_neigbours number of neighbours to use, 0 for 3 * sigma.
  * @param sigma sigma parameter of a gaussian repartition, more it'll be weak, more distance will influence weight.
- * @note side_neighbours indicates the radius in which neighbours wi'll be took. 
- * 
+ * @note side_neighbours indicates the radius in which neighbours wi'll be took.
+ *
  * @exception std::bad_alloc if output memory allocation failed
- * @return uint8_t* the blurred buffer
+ * @exception std::invalid_argument if sigma is not positive
+ * @return T* the blurred buffer
  */
-uint8_t *PixelsManager::gaussian_blur(const uint8_t *rgb_in, int rgb_len, int s_width, int s_height, int side_neigbours, float sigma)
+template <typename T>
+T *PixelsManager::gaussian_blur(const T *rgb_in, int rgb_len, int s_width, int s_height, int side_neigbours, float sigma)
 {
-    uint8_t *blur_out = new uint8_t[s_width * s_height * 3]; // output buffer
+    T *blur_out = new T[s_width * s_height * 3]; // output buffer
     if(!blur_out)
         throw std::bad_alloc();
 
-    // computing all pixels weights by distance in a radius of neighbours numbers input
-    std::map<int, float> pos_weight;
-    for(int i = -side_neigbours; i <= side_neigbours; ++i)
-        for(int j = -side_neigbours; j <= side_neigbours; ++j)
-            pos_weight[i+j] = (1 / (sigma * sigma * 2 * 3.14)) * exp((-pow((i - ((float)side_neigbours / 2)), 2.0) - (std::pow((j - ((float)side_neigbours / 2)), 2.0))) / (2 * sigma * sigma));
-    
-    for(int i = 0; i < s_height; ++i)
+    try
     {
-        for(int j = 0; j < s_width; ++j)
-        {
-            float s_r = 0, s_g = 0, s_b = 0, inc = 0;
-            for(int k = -side_neigbours; k <= side_neigbours; ++k)
-            {
-                for(int l = -side_neigbours; l <= side_neigbours; ++l)
-                {
-                    if (i + k < 0 || i + k >= s_height)
-                        continue;
-                    if (j + l < 0 || j + l >= s_width)
-                        continue;   
-
-                    int pos = k + l;
-                    s_r += rgb_in[((i + k) * s_width * 3) + ((j + l) * 3)] * pos_weight[pos];
-                    s_g += rgb_in[((i + k) * s_width * 3) + ((j + l) * 3) + 1] * pos_weight[pos];
-                    s_b += rgb_in[((i + k) * s_width * 3) + ((j + l) * 3) + 2] * pos_weight[pos];
-                    inc = inc + pos_weight[pos];
-                }
-            }
-            blur_out[(i * s_width * 3) + (j * 3)] =  s_r / inc;   
-            blur_out[(i * s_width * 3) + (j * 3) + 1] = s_g / inc;       
-            blur_out[(i * s_width * 3) + (j * 3) + 2] = s_b / inc;
-        }
+        Blur::gaussian(ImageView<const T>(rgb_in, s_width, s_height, 3), ImageView<T>(blur_out, s_width, s_height, 3), sigma, side_neigbours);
     }
-    return blur_out; 
-}
\ No newline at end of file
+    catch (const std::exception &)
+    {
+        delete[] blur_out;
+        throw;
+    }
+    return blur_out;
+}
+
+/**
+ * @brief Method for bluring an input image with gaussian weights
+ * @details same weighted average as the buffer version, for images of 1 to 4 channels with padded rows.
+ * @see Blur::gaussian
+ *
+ * @tparam T the sample type : uint8_t, uint16_t (native byte order) or float
+ * @param image_in the input image
+ * @param image_out the blurred output image, of the same size and channels number
+ * @param side_neigbours number of neighbours to use, 0 for 3 * sigma.
+ * @param sigma sigma parameter of a gaussian repartition, more it'll be weak, more distance will influence weight.
+ *
+ * @exception std::invalid_argument if the images don't match, or have more than 4 channels, if sigma is not positive
+ */
+template <typename T>
+void PixelsManager::gaussian_blur(ImageView<const typename ImageView<T>::sample_type> image_in, ImageView<T> image_out, int side_neigbours, float sigma)
+{
+    Blur::gaussian(image_in, image_out, sigma, side_neigbours);
+}
+
+/*
+ * Instantiations of the templated methods : 8 bits, 16 bits (native byte order) and float samples
+ */
+
+template uint8_t *PixelsManager::rgb_to_grayscale<uint8_t>(const uint8_t *, int, int, int &);
+template uint16_t *PixelsManager::rgb_to_grayscale<uint16_t>(const uint16_t *, int, int, int &);
+template float *PixelsManager::rgb_to_grayscale<float>(const float *, int, int, int &);
+template void PixelsManager::rgb_to_grayscale<uint8_t>(ImageView<const uint8_t>, ImageView<uint8_t>, int);
+template void PixelsManager::rgb_to_grayscale<uint16_t>(ImageView<const uint16_t>, ImageView<uint16_t>, int);
+template void PixelsManager::rgb_to_grayscale<float>(ImageView<const float>, ImageView<float>, int);
+
+template uint8_t *PixelsManager::grayscale_to_otsu<uint8_t>(const uint8_t *, int, int &);
+template uint16_t *PixelsManager::grayscale_to_otsu<uint16_t>(const uint16_t *, int, int &);
+
+template uint8_t *PixelsManager::blur<uint8_t>(const uint8_t *, int, int, int, int, int);
+template uint16_t *PixelsManager::blur<uint16_t>(const uint16_t *, int, int, int, int, int);
+template float *PixelsManager::blur<float>(const float *, int, int, int, int, int);
+template void PixelsManager::blur<uint8_t>(ImageView<const uint8_t>, ImageView<uint8_t>, int, int);
+template void PixelsManager::blur<uint16_t>(ImageView<const uint16_t>, ImageView<uint16_t>, int, int);
+template void PixelsManager::blur<float>(ImageView<const float>, ImageView<float>, int, int);
+
+template uint8_t *PixelsManager::gaussian_blur<uint8_t>(const uint8_t *, int, int, int, int, float);
+template uint16_t *PixelsManager::gaussian_blur<uint16_t>(const uint16_t *, int, int, int, int, float);
+template float *PixelsManager::gaussian_blur<float>(const float *, int, int, int, int, float);
+template void PixelsManager::gaussian_blur<uint8_t>(ImageView<const uint8_t>, ImageView<uint8_t>, int, float);
+template void PixelsManager::gaussian_blur<uint16_t>(ImageView<const uint16_t>, ImageView<uint16_t>, int, float);
+template void PixelsManager::gaussian_blur<float>(ImageView<const float>, ImageView<float>, int, float);
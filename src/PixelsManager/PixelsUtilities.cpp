@@ -2,6 +2,7 @@
 
 #include "../../include/PixelsManager/PixelsManager.h"
 #include "../../include/PixelsManager/PixelsUtilities.h"
+#include "../../include/PixelsManager/KMeans.h"
 
 /**
  * @brief method to get all R,G,B 3-tutple possibilities from an input value which verifies a specific condition
@@ -192,69 +193,32 @@ long long unsigned int PixelsUtilities::combination(long long unsigned int p, lo
 
 /**
  * @brief kmean method(Lloyd method implementation)
+ * @see KMeans::cluster
  * 
  * @param points reference input vector points
- * @param iters number of iterations to perform
+ * @param iters maximum number of iterations to perform, less are done when the clusters don't move anymore
  * @param nb_clusters number of clusters.
- * @return void. the input points are modified, for each point is assigned a cluster.
+ * @return void. the input points are modified, for each point is assigned a cluster and its squared distance to the cluster centroid.
+ * @exception std::invalid_argument if the clusters number is not positive or the iterations number is negative
  */
 void PixelsUtilities::kMeansClustering(std::vector<PixelsUtilities::Kmean_point> &points, int iters, int nb_clusters)
 {
-    int n = points.size();
-    std::vector<PixelsUtilities::Kmean_point> centroids;
+    if (points.empty())
+        return;
 
-    srand(91);
-    for (int i = 0; i < nb_clusters; ++i)
-        centroids.push_back(points.at(rand() % n));
+    KMeans::Points coordinates;
+    coordinates.x.reserve(points.size());
+    coordinates.y.reserve(points.size());
+    coordinates.z.reserve(points.size());
+    coordinates.weights.reserve(points.size());
+    for (const auto &point : points)
+        coordinates.push_back(point.r, point.g, point.b);
 
-    for (int i = 0; i < iters; ++i)
+    const KMeans::Clustering clustering{KMeans::cluster(coordinates, nb_clusters, iters)};
+    for (std::size_t i = 0; i < points.size(); ++i)
     {
-        for (auto centroid = centroids.begin(); centroid != centroids.end(); ++centroid)
-        {
-            int clusterId = centroid - centroids.begin();
-            
-            for (auto it = points.begin(); it != points.end(); ++it)
-            {
-                Kmean_point p = *it;
-                double dist = centroid->distance(p);
-                if (dist < p.minDist)
-                {
-                    p.minDist = dist;
-                    p.cluster = clusterId;
-                }
-                *it = p;
-            }
-        }
-
-        std::vector<int> nPoints;
-        std::vector<double> sumR, sumG, sumB;
-        for (int j = 0; j < nb_clusters; ++j)
-        {
-            nPoints.push_back(0);
-            sumR.push_back(0.0);
-            sumG.push_back(0.0);
-            sumB.push_back(0.0);
-
-        }
-
-        for(auto &itr : points)
-        {
-            int clusterId = itr.cluster;
-            nPoints[clusterId] += 1;
-            sumR[clusterId] += itr.r;
-            sumG[clusterId] += itr.g;
-            sumB[clusterId] += itr.b;
-
-            itr.minDist = __DBL_MAX__;
-        }
-
-        for (auto centroid = centroids.begin(); centroid != centroids.end(); ++centroid)
-        {
-            int clusterId = centroid - centroids.begin();
-            centroid->r = sumR[clusterId] / nPoints[clusterId];
-            centroid->g = sumG[clusterId] / nPoints[clusterId];
-            centroid->b = sumB[clusterId] / nPoints[clusterId];
-        }
+        points[i].cluster = clustering.labels[i];
+        points[i].minDist = clustering.distances[i];
     }
 }
 